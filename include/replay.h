@@ -0,0 +1,79 @@
+#ifndef REPLAY_HEADER
+#define REPLAY_HEADER
+
+#include "pd_api.h"
+#include "voxel_terrain.h"
+#include "terrain_query.h"
+
+#define REPLAY_MAGIC    (0x50525456u) // 'VTRP'
+#define REPLAY_VERSION  (1u)
+
+// Half an hour at 50Hz - recordings stop & longer files are rejected
+#define REPLAY_MAX_FRAMES   (50u * 60u * 30u)
+
+#pragma pack(push, 1)
+
+typedef struct ReplayHeader
+{
+    uint32_t        magic;
+    uint16_t        version;
+    uint32_t        frameCount;
+
+    // View at the start of the recording
+    Vector3         position;
+    float           yaw;
+    float           pitch;
+    float           roll;
+} ReplayHeader;
+
+typedef struct ReplayFrame
+{
+    float           dt;
+    float           crankChange;
+    uint8_t         buttons;
+} ReplayFrame;
+
+#pragma pack(pop)
+
+// View driven by the per-frame input, whether live or played back
+typedef struct ReplayView
+{
+    Vector3         position;
+    float           yaw;
+    float           pitch;
+    float           roll;
+} ReplayView;
+
+typedef struct Replay
+{
+    ReplayHeader    header;
+    ReplayFrame*    frames;
+    unsigned int    capacity;
+    unsigned int    cursor;
+} Replay;
+
+struct replay_api
+{
+    Replay* (*newReplay)(const Vector3* position, const float yaw, const float pitch, const float roll);
+    Replay* (*loadFromFile)(PlaydateAPI* pd, const char* path);
+    int (*saveToFile)(PlaydateAPI* pd, const Replay* replay, const char* path);
+
+    // Append a frame while recording, returns 0 if out of memory
+    int (*record)(Replay* replay, const ReplayFrame* frame);
+
+    // Read the next frame while playing back, returns 0 once all frames have been played
+    int (*next)(Replay* replay, ReplayFrame* frame);
+
+    // View at the start of the recording
+    ReplayView (*startView)(const Replay* replay);
+
+    // Move the view by a frame of input, keeping it above the terrain - the same frames from the same view always end at the same view
+    void (*stepView)(ReplayView* view, const ReplayFrame* frame, const HeightQuery* query);
+
+    void (*freeReplay)(Replay*);
+};
+
+// Convenience
+extern const struct replay_api replay;
+
+#endif
\ No newline at end of file
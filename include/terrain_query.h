@@ -0,0 +1,42 @@
+#ifndef TERRAIN_QUERY_HEADER
+#define TERRAIN_QUERY_HEADER
+
+#include "voxel_terrain.h"
+
+// Upper bound on the number of cells visited by a single ray - keeps the cost of a query bounded
+#define QUERY_MAX_STEPS     (512u)
+#define QUERY_MAX_LEVELS    (16u)
+
+// Raycast results - a ray which runs out of steps before reaching 'maxT' is unresolved
+#define QUERY_MISS          (0)
+#define QUERY_HIT           (1)
+#define QUERY_UNRESOLVED    (-1)
+
+typedef struct HeightQuery
+{
+    const HeightMap*    heightmap;
+
+    // Max height hierarchy - level 'n' holds the max of a 2^n x 2^n block of samples, level 0 is the heightmap itself
+    uint8_t*            levels[QUERY_MAX_LEVELS];
+    unsigned int        widths[QUERY_MAX_LEVELS];
+    unsigned int        heights[QUERY_MAX_LEVELS];
+    unsigned int        levelCount;
+} HeightQuery;
+
+// Queries are in heightmap sample space for x/z, heights are normalised in [0, 1] like the view position
+HeightQuery* terrain_query_new(const HeightMap* heightmap);
+void terrain_query_free(HeightQuery* query);
+
+// Height of the voxel column at x/z, matching what is drawn
+float terrain_query_getHeightAt(const HeightQuery* query, const float x, const float z);
+
+// Bilinearly filtered height at x/z, for smooth ground following
+float terrain_query_getHeightAtLinear(const HeightQuery* query, const float x, const float z);
+
+// Cast 'origin + t * direction' for t in [0, maxT] and return one of the QUERY_ results, with the hit position written to 'hit' if set
+int terrain_query_raycast(const HeightQuery* query, const Vector3* origin, const Vector3* direction, const float maxT, Vector3* hit);
+
+// Line of sight between each pair of points, writes 1 to 'visible' when unobstructed - unresolved rays are treated as blocked
+void terrain_query_lineOfSight(const HeightQuery* query, const Vector3* from, const Vector3* to, uint8_t* visible, const unsigned int count);
+
+#endif
\ No newline at end of file
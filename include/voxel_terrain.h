@@ -1,6 +1,8 @@
 #ifndef VOXEL_TERRAIN_HEADER
 #define VOXEL_TERRAIN_HEADER
 
+#include <stddef.h>
+
 #include "pd_api.h"
 #include "bitmap.h"
 
@@ -17,11 +19,33 @@ typedef struct Vector3
     float z;
 } Vector3;
 
-typedef struct DitherMap
+typedef struct MapSampler
 {
-    uint8_t*        data;
     unsigned int    width;
     unsigned int    height;
+    unsigned int    stride;
+
+    // 'size - 1' for power of two sizes, '0' otherwise
+    unsigned int    widthMask;
+    unsigned int    heightMask;
+} MapSampler;
+
+typedef struct DitherMap
+{
+    uint8_t*        data;
+    union
+    {
+        struct
+        {
+            unsigned int    width;
+            unsigned int    height;
+            unsigned int    stride;
+            unsigned int    widthMask;
+            unsigned int    heightMask;
+        };
+
+        MapSampler          sampler;
+    };
 } DitherMap;
 
 typedef struct TerrainSample
@@ -42,15 +66,107 @@ typedef struct TerrainSample
 typedef struct HeightMap
 {
     TerrainSample*  data;
+    union
+    {
+        struct
+        {
+            unsigned int    width;
+            unsigned int    height;
+            unsigned int    stride;
+            unsigned int    widthMask;
+            unsigned int    heightMask;
+        };
+
+        MapSampler          sampler;
+    };
+} HeightMap;
+
+// Maps repeat the sampler's fields so that they can be accessed directly - make sure both layouts stay in sync
+#define MAP_SAMPLER_LAYOUT_MATCHES(TYPE)                                                                       \
+    (offsetof(TYPE, width)      == offsetof(TYPE, sampler) + offsetof(MapSampler, width)        &&      \
+     offsetof(TYPE, height)     == offsetof(TYPE, sampler) + offsetof(MapSampler, height)       &&      \
+     offsetof(TYPE, stride)     == offsetof(TYPE, sampler) + offsetof(MapSampler, stride)       &&      \
+     offsetof(TYPE, widthMask)  == offsetof(TYPE, sampler) + offsetof(MapSampler, widthMask)    &&      \
+     offsetof(TYPE, heightMask) == offsetof(TYPE, sampler) + offsetof(MapSampler, heightMask)   &&      \
+     sizeof(MapSampler)         == 5 * sizeof(unsigned int))
+
+_Static_assert(MAP_SAMPLER_LAYOUT_MATCHES(DitherMap), "DitherMap fields must match MapSampler");
+_Static_assert(MAP_SAMPLER_LAYOUT_MATCHES(HeightMap), "HeightMap fields must match MapSampler");
+
+static inline MapSampler voxel_terrain_newSampler(const unsigned int width, const unsigned int height)
+{
+    return (MapSampler)
+    {
+        .width      = width,
+        .height     = height,
+        .stride     = width,
+        .widthMask  = (width  & (width  - 1u)) == 0u ? width  - 1u : 0u,
+        .heightMask = (height & (height - 1u)) == 0u ? height - 1u : 0u
+    };
+}
+
+// Wrap around, including negative coordinates - power of two sizes only need a mask
+static inline unsigned int voxel_terrain_wrap(const int value, const unsigned int size, const unsigned int mask)
+{
+    if (mask)
+    {
+        return (unsigned int)value & mask;
+    }
+
+    const int wrapped = value % (int)size;
+    return (unsigned int)(wrapped < 0 ? wrapped + (int)size : wrapped);
+}
+
+static inline unsigned int voxel_terrain_sampleIndex(const MapSampler* sampler, const int x, const int y)
+{
+    return voxel_terrain_wrap(x, sampler->width, sampler->widthMask) + voxel_terrain_wrap(y, sampler->height, sampler->heightMask) * sampler->stride;
+}
+
+// Number of depth slices recorded per screen column in the occlusion buffer
+#define OCCLUSION_SLICES    (16u)
+
+typedef struct OcclusionBuffer
+{
+    // For each screen column, the top of the terrain nearer than each depth slice
+    uint8_t*        data;
     unsigned int    width;
     unsigned int    height;
-} HeightMap;
+
+    // View the buffer was last drawn with
+    Vector3         position;
+    float           yaw;
+    float           pitch;
+    float           roll;
+    uint16_t        near;
+    uint16_t        far;
+    float           scaleXZ;
+    float           scale;
+} OcclusionBuffer;
+
+typedef struct Billboard
+{
+    // Position & radius are in heightmap samples like the terrain queries, height is normalised like the view's 'position.y'
+    Vector3         position;
+    float           radius;
+    float           height;
+    uint8_t         luminance;
+} Billboard;
 
 HeightMap* voxel_terrain_newHeightMap(const Bitmap* heightmap, const Bitmap* colourmap, int scale);
 DitherMap* voxel_terrain_newDitherMap(const Bitmap* colourmap);
 
+OcclusionBuffer* voxel_terrain_newOcclusionBuffer(const int width, const int height);
+
 void voxel_terrain_freeHeightMap(HeightMap* heightmap);
 void voxel_terrain_freeDitherMap(DitherMap* heightmap);
+void voxel_terrain_freeOcclusionBuffer(OcclusionBuffer* occlusion);
+
+TerrainSample voxel_terrain_getSample(const HeightMap* heightmap, int x, int y);
+TerrainSample voxel_terrain_getSampleLinear(const HeightMap* heightmap, const float x, const float y);
+
+// Screen-space top of the terrain nearer than 'depth' for a given column, or the screen height if nothing occludes
+uint8_t voxel_terrain_getOcclusion(const OcclusionBuffer* occlusion, const int x, const float depth);
+
 void voxel_terrain_draw(
     uint8_t* bitmapData, 
     const uint16_t rowBytes,
@@ -65,6 +181,26 @@ void voxel_terrain_draw(
     const float scaleXZ, 
     float scale, 
     const int width, 
-    const int height);
+    const int height,
+    OcclusionBuffer* occlusion);
+
+// Draw a floating layer (e.g. clouds) using the view of the last terrain draw - each sample spans from 'altitude' up by its height,
+// samples with a height of '0' are empty. The layer is depth tested against the occlusion buffer but not written to it
+void voxel_terrain_drawLayer(
+    uint8_t* bitmapData,
+    const uint16_t rowBytes,
+    const DitherMap* dithermap,
+    const HeightMap* layer,
+    const float altitude,
+    const OcclusionBuffer* occlusion);
+
+// Draw billboards depth tested against the occlusion buffer - billboards are not sorted against each other
+void voxel_terrain_drawBillboards(
+    uint8_t* bitmapData,
+    const uint16_t rowBytes,
+    const DitherMap* dithermap,
+    const OcclusionBuffer* occlusion,
+    const Billboard* billboards,
+    const unsigned int count);
 
 #endif
\ No newline at end of file
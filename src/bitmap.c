@@ -16,7 +16,11 @@ Bitmap* bitmap_loadFromFile(PlaydateAPI* pd, const char* path)
             pd->file->read(bitmapFile, &newBitmap->fileHeader, sizeof(BitmapFileHeader));
             pd->file->read(bitmapFile, &newBitmap->infoHeader, sizeof(BitmapInfoHeader));
 
-            size_t dataSize = newBitmap->infoHeader.biWidth * newBitmap->infoHeader.biHeight * sizeof(BitmapPixel);
+            // If the height is negative, the bitmap is top-down
+            const unsigned int bitmapHeight = abs(newBitmap->infoHeader.biHeight);
+            const int topDown               = newBitmap->infoHeader.biHeight < 0;
+
+            size_t dataSize = newBitmap->infoHeader.biWidth * bitmapHeight * sizeof(BitmapPixel);
             newBitmap->data = (BitmapPixel*)malloc(dataSize);
 
             if (newBitmap->data)
@@ -25,16 +29,17 @@ Bitmap* bitmap_loadFromFile(PlaydateAPI* pd, const char* path)
 
                 if (newBitmap->infoHeader.biBitCount == 24)
                 {
-                    for (int h = 0; h < newBitmap->infoHeader.biHeight; ++h)
+                    // Rows are padded to 4 bytes
+                    const unsigned char padding = (4u - (newBitmap->infoHeader.biWidth * sizeof(BitmapPixel)) % 4u) % 4u;
+
+                    for (unsigned int h = 0; h < bitmapHeight; ++h)
                     {
                         for (unsigned int w = 0; w < newBitmap->infoHeader.biWidth; ++w)
                         {
-                            // If the height is negative, the bitmap is top-down
-                            size_t index = newBitmap->infoHeader.biHeight < 0 ? w + h * newBitmap->infoHeader.biWidth : w + (newBitmap->infoHeader.biHeight - h - 1) * newBitmap->infoHeader.biWidth;
+                            size_t index = topDown ? w + h * newBitmap->infoHeader.biWidth : w + (bitmapHeight - h - 1) * newBitmap->infoHeader.biWidth;
                             pd->file->read(bitmapFile, &newBitmap->data[index], sizeof(BitmapPixel));
                         }
 
-                        const unsigned char padding = ((newBitmap->infoHeader.biWidth * sizeof(BitmapPixel)) % 4) * sizeof(unsigned char);
                         pd->file->seek(bitmapFile, padding, SEEK_CUR);
                     }
                 }
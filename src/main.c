@@ -12,6 +12,8 @@
 #include "pd_api.h"
 
 #include "voxel_terrain.h"
+#include "terrain_query.h"
+#include "replay.h"
 
 static int update(void* userdata);
 const char* fontpath = "/System/Fonts/Asheville-Sans-14-Bold.pft";
@@ -19,13 +21,127 @@ LCDFont* font = NULL;
 
 DitherMap* ditherMap;
 HeightMap* heightmap;
+HeightMap* cloudLayer;
+OcclusionBuffer* occlusion;
+HeightQuery* query;
+
+// Billboards - trees scattered over the map & one aircraft circling the start position
+#define TREE_COUNT      (256)
+#define BILLBOARD_COUNT (TREE_COUNT + 1)
+Billboard billboards[BILLBOARD_COUNT];
+
+// Line of sight from the view to every tree
+Vector3 sightFrom[TREE_COUNT];
+Vector3 sightTo[TREE_COUNT];
+uint8_t sightVisible[TREE_COUNT];
+int sightCount;
 
 int frameCounter;
 
+// Timings averaged over a number of frames, measured with the high resolution elapsed time
+#define PROFILE_FRAMES 50
+
+typedef struct Profile
+{
+    float   total;
+    float   average;
+    int     frames;
+} Profile;
+
+Profile terrainProfile;
+Profile billboardProfile;
+Profile layerProfile;
+Profile queryProfile;
+
+// Clouds - the peaks of the height map floating above the terrain, at the same scale so they sit over the peaks
+#define CLOUD_THRESHOLD (150)
+#define CLOUD_ALTITUDE  (1.1f)
+
+static void profileAdd(Profile* profile, const float seconds)
+{
+    profile->total += seconds;
+
+    if (++profile->frames == PROFILE_FRAMES)
+    {
+        profile->average    = profile->total / PROFILE_FRAMES;
+        profile->total      = 0.0f;
+        profile->frames     = 0;
+    }
+}
+
+// Replay
+#define REPLAY_OFF          0
+#define REPLAY_RECORDING    1
+#define REPLAY_PLAYING      2
+#define REPLAY_PATH         "replay.bin"
+int replayMode = REPLAY_OFF;
+Replay* activeReplay = NULL;
+PDMenuItem* recordMenuItem = NULL;
+
+ReplayView view;
+
+static void stopReplay(PlaydateAPI* pd)
+{
+    if (replayMode == REPLAY_RECORDING)
+    {
+        if (!replay.saveToFile(pd, activeReplay, REPLAY_PATH))
+        {
+            pd->system->logToConsole("%s:%i Couldn't save replay %s: %s", __FILE__, __LINE__, REPLAY_PATH, pd->file->geterr());
+        }
+
+        pd->system->setMenuItemValue(recordMenuItem, 0);
+    }
+
+    if (activeReplay)
+    {
+        replay.freeReplay(activeReplay);
+        activeReplay = NULL;
+    }
+
+    replayMode = REPLAY_OFF;
+}
+
+static void recordMenuCallback(void* userdata)
+{
+    PlaydateAPI* pd = userdata;
+
+    if (pd->system->getMenuItemValue(recordMenuItem))
+    {
+        stopReplay(pd);
+
+        activeReplay = replay.newReplay(&view.position, view.yaw, view.pitch, view.roll);
+        replayMode   = activeReplay ? REPLAY_RECORDING : REPLAY_OFF;
+    }
+    else
+    {
+        stopReplay(pd);
+    }
+}
+
+static void replayMenuCallback(void* userdata)
+{
+    PlaydateAPI* pd = userdata;
+
+    stopReplay(pd);
+
+    activeReplay = replay.loadFromFile(pd, REPLAY_PATH);
+
+    if (activeReplay)
+    {
+        // Start off from the recorded view, from then on the view only depends on the recorded frames
+        view        = replay.startView(activeReplay);
+        replayMode  = REPLAY_PLAYING;
+    }
+}
+
 static int cleanup(PlaydateAPI* pd)
 {
     voxel_terrain_freeHeightMap(heightmap);
+    voxel_terrain_freeHeightMap(cloudLayer);
     voxel_terrain_freeDitherMap(ditherMap);
+    voxel_terrain_freeOcclusionBuffer(occlusion);
+    terrain_query_free(query);
+    stopReplay(pd);
 
     return 0;
 }
@@ -55,6 +171,10 @@ int eventHandler(PlaydateAPI* pd, PDSystemEvent event, uint32_t arg)
 
         // Maximum speed
         pd->display->setRefreshRate(50.0f);
+
+        // Record inputs to / play them back from the data folder
+        recordMenuItem = pd->system->addCheckmarkMenuItem("record", 0, recordMenuCallback, pd);
+        pd->system->addMenuItem("replay", replayMenuCallback, pd);
     }
 
     if (event == kEventTerminate)
@@ -73,11 +193,6 @@ int eventHandler(PlaydateAPI* pd, PDSystemEvent event, uint32_t arg)
 #define STATE_UPDATE 1
 int state = STATE_INIT;
 
-Vector3 viewPosition;
-float pitch;
-float yaw;
-float roll;
-
 static int initUpdate(PlaydateAPI* pd)
 {
     Bitmap* ditherBitmap = bitmap.loadFromFile(pd, "images/bayer16tile2.bmp");
@@ -85,22 +200,55 @@ static int initUpdate(PlaydateAPI* pd)
     Bitmap* colourBitmap = bitmap.loadFromFile(pd, "images/C1W.bmp");
 
     heightmap = voxel_terrain_newHeightMap(heightBitmap, colourBitmap, 4);
+    cloudLayer = voxel_terrain_newHeightMap(heightBitmap, colourBitmap, 4);
     ditherMap = voxel_terrain_newDitherMap(ditherBitmap);
+    occlusion = voxel_terrain_newOcclusionBuffer(LCD_COLUMNS, LCD_ROWS);
+    query     = terrain_query_new(heightmap);
 
     bitmap.freeBitmap(heightBitmap);
     bitmap.freeBitmap(colourBitmap);
     bitmap.freeBitmap(ditherBitmap);
 
-    viewPosition = (Vector3)
+    // Only keep thin clouds where the height map peaks
+    for (unsigned int i = 0; i < cloudLayer->stride * cloudLayer->height; ++i)
     {
-        .x = heightmap->width / 2.0f,
-        .y = 0.5f,
-        .z = heightmap->height / 2.0f
+        const int height = cloudLayer->data[i].height;
+
+        cloudLayer->data[i].height      = height > CLOUD_THRESHOLD ? (uint8_t)((height - CLOUD_THRESHOLD) / 4) : 0;
+        cloudLayer->data[i].luminance   = 160;
+    }
+
+    view = (ReplayView)
+    {
+        .position   = { .x = heightmap->width / 2.0f, .y = 0.5f, .z = heightmap->height / 2.0f },
+        .yaw        = 0.0f,
+        .pitch      = 0.0f,
+        .roll       = 0.0f
     };
 
-    yaw     = 0.0f;
-    pitch   = 0.0f;
-    roll    = 0.0f;
+    srand(0);
+
+    for (int i = 0; i < TREE_COUNT; ++i)
+    {
+        const float x = (float)(rand() % heightmap->width);
+        const float z = (float)(rand() % heightmap->height);
+
+        billboards[i] = (Billboard)
+        {
+            .position   = { .x = x, .y = terrain_query_getHeightAt(query, x, z), .z = z },
+            .radius     = 1.5f,
+            .height     = 0.04f,
+            .luminance  = 32
+        };
+    }
+
+    billboards[TREE_COUNT] = (Billboard)
+    {
+        .position   = view.position,
+        .radius     = 4.0f,
+        .height     = 0.02f,
+        .luminance  = 0
+    };
 
     frameCounter = 0;
 
@@ -128,83 +276,109 @@ static int mainUpdate(PlaydateAPI* pd)
             // Pass NULL instead to draw lines
             uint8_t* data = pd->graphics->getFrame();
 
-            voxel_terrain_draw(data, LCD_ROWSIZE, ditherMap, heightmap, &viewPosition, yaw, pitch, roll, near, far, 2.0f * 0.5f, 20000.0f, LCD_COLUMNS, LCD_ROWS);
-        }
+            // Measure the cost of drawing the terrain, including the occlusion buffer output
+            const float terrainStart = pd->system->getElapsedTime();
 
-        char* buffer;
-        pd->system->formatString(&buffer, "Position x=%i y=%i z=%i", (int)viewPosition.x, (int)viewPosition.y, (int)viewPosition.z);
+            voxel_terrain_draw(data, LCD_ROWSIZE, ditherMap, heightmap, &view.position, view.yaw, view.pitch, view.roll, near, far, 2.0f * 0.5f, 20000.0f, LCD_COLUMNS, LCD_ROWS, occlusion);
 
-        pd->graphics->setDrawMode(kDrawModeFillBlack);
-        pd->graphics->drawText(buffer, strlen(buffer), kASCIIEncoding, 1, 16);
-    }
+            profileAdd(&terrainProfile, pd->system->getElapsedTime() - terrainStart);
 
-    // Coarse dt
-    float dt = pd->system->getElapsedTime();
-    pd->system->resetElapsedTime();
+            // Aircraft circling the start position
+            {
+                const float angle = frameCounter * 0.02f;
 
-    float xzSpeed = 50.0f;
-    float ySpeed  = 1.0f;
-    float rSpeed  = 50.0f;
+                billboards[TREE_COUNT].position.x = heightmap->width  / 2.0f + 60.0f * cosf(angle);
+                billboards[TREE_COUNT].position.z = heightmap->height / 2.0f + 60.0f * sinf(angle);
+                billboards[TREE_COUNT].position.y = 0.6f;
+            }
 
-    // Input
-    if (1)
-    {
-        const float cosPhi  = cosf(yaw);
-        const float sinPhi  = sinf(yaw);
+            // Measure the cost of compositing billboards & clouds against the occlusion buffer
+            const float billboardStart = pd->system->getElapsedTime();
 
-        if (current & kButtonLeft)
-        {
-            roll -= rSpeed * dt;
-            yaw += ySpeed * dt * MAX(-roll / 45.0f, 0.0f);
-        }
-        
-        if (current & kButtonRight)
-        {
-            roll += rSpeed * dt;
-            yaw -= ySpeed * dt * MAX(roll / 45.0f, 0.0f);
-        }
+            voxel_terrain_drawBillboards(data, LCD_ROWSIZE, ditherMap, occlusion, billboards, BILLBOARD_COUNT);
 
-        // Clamp + decay
-        {
-            roll = CLAMP(roll, -45.0f, 45.0f);
-            roll = LERP(roll, 0.0f, 0.5f * dt);
-        }
+            const float layerStart = pd->system->getElapsedTime();
 
-        if (current & kButtonUp)
-        {
-            viewPosition.x -= sinPhi * xzSpeed * dt;
-            viewPosition.z -= cosPhi * xzSpeed * dt;
-        }
+            voxel_terrain_drawLayer(data, LCD_ROWSIZE, ditherMap, cloudLayer, CLOUD_ALTITUDE, occlusion);
 
-        if (current & kButtonDown)
-        {
-            viewPosition.x += sinPhi * xzSpeed * dt;
-            viewPosition.z += cosPhi * xzSpeed * dt;
-        }
+            const float layerEnd = pd->system->getElapsedTime();
 
-        // Constant forward motion
-        {
-            viewPosition.x -= sinPhi * xzSpeed * dt;
-            viewPosition.z -= cosPhi * xzSpeed * dt;
-        }
+            profileAdd(&billboardProfile, layerStart - billboardStart);
+            profileAdd(&layerProfile, layerEnd - layerStart);
 
-        if (current & kButtonB)
-        {
-            viewPosition.y -= 1 * ySpeed * dt;
+            // Measure the cost of a batch of line of sight queries
+            for (int i = 0; i < TREE_COUNT; ++i)
+            {
+                sightFrom[i]    = view.position;
+                sightTo[i]      = billboards[i].position;
+                sightTo[i].y   += billboards[i].height;
+            }
+
+            const float queryStart = pd->system->getElapsedTime();
+
+            terrain_query_lineOfSight(query, sightFrom, sightTo, sightVisible, TREE_COUNT);
+
+            profileAdd(&queryProfile, pd->system->getElapsedTime() - queryStart);
+
+            sightCount = 0;
 
-            if (viewPosition.y < 0.0f)
+            for (int i = 0; i < TREE_COUNT; ++i)
             {
-                viewPosition.y = 0.0f;
+                sightCount += sightVisible[i];
             }
         }
 
-        if (current & kButtonA)
+        char* buffer;
+        pd->system->formatString(&buffer, "Position x=%i y=%i z=%i", (int)view.position.x, (int)view.position.y, (int)view.position.z);
+
+        pd->graphics->setDrawMode(kDrawModeFillBlack);
+        pd->graphics->drawText(buffer, strlen(buffer), kASCIIEncoding, 1, 16);
+        pd->system->realloc(buffer, 0);
+
+        pd->system->formatString(&buffer, "Terrain t=%ius Clouds t=%ius", (int)(terrainProfile.average * 1000000.0f), (int)(layerProfile.average * 1000000.0f));
+        pd->graphics->drawText(buffer, strlen(buffer), kASCIIEncoding, 1, 32);
+        pd->system->realloc(buffer, 0);
+
+        pd->system->formatString(&buffer, "Billboards n=%i t=%ius", BILLBOARD_COUNT, (int)(billboardProfile.average * 1000000.0f));
+        pd->graphics->drawText(buffer, strlen(buffer), kASCIIEncoding, 1, 48);
+        pd->system->realloc(buffer, 0);
+
+        pd->system->formatString(&buffer, "Queries n=%i visible=%i t=%ius", TREE_COUNT, sightCount, (int)(queryProfile.average * 1000000.0f));
+        pd->graphics->drawText(buffer, strlen(buffer), kASCIIEncoding, 1, 64);
+        pd->system->realloc(buffer, 0);
+
+        if (replayMode != REPLAY_OFF)
         {
-            viewPosition.y += 1 * ySpeed * dt;
+            const unsigned int replayFrame = replayMode == REPLAY_PLAYING ? activeReplay->cursor : activeReplay->header.frameCount;
+
+            pd->system->formatString(&buffer, "%s frame=%i", replayMode == REPLAY_PLAYING ? "Replay" : "Record", replayFrame);
+            pd->graphics->drawText(buffer, strlen(buffer), kASCIIEncoding, 1, 80);
+            pd->system->realloc(buffer, 0);
         }
+    }
+
+    // Coarse dt
+    ReplayFrame input = (ReplayFrame)
+    {
+        .dt             = pd->system->getElapsedTime(),
+        .crankChange    = pd->system->getCrankChange(),
+        .buttons        = (uint8_t)current
+    };
 
-        pitch += pd->system->getCrankChange() / 360.0f;
+    pd->system->resetElapsedTime();
+
+    // Replace live input with the recorded one, or record it
+    if (replayMode == REPLAY_PLAYING && !replay.next(activeReplay, &input))
+    {
+        stopReplay(pd);
     }
+    else if (replayMode == REPLAY_RECORDING && !replay.record(activeReplay, &input))
+    {
+        stopReplay(pd);
+    }
+
+    // Same view update whether the input is live or played back
+    replay.stepView(&view, &input, query);
 
     pd->graphics->setDrawMode(kDrawModeFillWhite);
     pd->system->drawFPS(0, 0);
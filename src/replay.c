@@ -0,0 +1,246 @@
+#include "replay.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+// View speeds per second
+#define REPLAY_XZ_SPEED         (50.0f)
+#define REPLAY_Y_SPEED          (1.0f)
+#define REPLAY_ROLL_SPEED       (50.0f)
+
+// Minimum height of the view above the ground
+#define REPLAY_GROUND_CLEARANCE (0.05f)
+
+Replay* replay_newReplay(const Vector3* position, const float yaw, const float pitch, const float roll)
+{
+    Replay* newReplay = (Replay*)malloc(sizeof(Replay));
+
+    if (newReplay)
+    {
+        newReplay->header = (ReplayHeader)
+        {
+            .magic      = REPLAY_MAGIC,
+            .version    = REPLAY_VERSION,
+            .frameCount = 0u,
+            .position   = *position,
+            .yaw        = yaw,
+            .pitch      = pitch,
+            .roll       = roll
+        };
+
+        newReplay->frames   = NULL;
+        newReplay->capacity = 0u;
+        newReplay->cursor   = 0u;
+    }
+
+    return newReplay;
+}
+
+void replay_freeReplay(Replay* replay)
+{
+    free(replay->frames);
+    free(replay);
+}
+
+Replay* replay_loadFromFile(PlaydateAPI* pd, const char* path)
+{
+    SDFile* replayFile = pd->file->open(path, kFileRead | kFileReadData);
+
+    if (replayFile)
+    {
+        Replay* newReplay = (Replay*)malloc(sizeof(Replay));
+
+        if (newReplay)
+        {
+            newReplay->frames   = NULL;
+            newReplay->capacity = 0u;
+            newReplay->cursor   = 0u;
+
+            const int headerSize = pd->file->read(replayFile, &newReplay->header, sizeof(ReplayHeader));
+
+            // Frame count comes from the file, bound it before allocating
+            if (headerSize == sizeof(ReplayHeader) && newReplay->header.magic == REPLAY_MAGIC && newReplay->header.version == REPLAY_VERSION
+                && newReplay->header.frameCount > 0u && newReplay->header.frameCount <= REPLAY_MAX_FRAMES)
+            {
+                const unsigned int dataSize = newReplay->header.frameCount * sizeof(ReplayFrame);
+                newReplay->frames           = (ReplayFrame*)malloc(dataSize);
+
+                if (newReplay->frames)
+                {
+                    newReplay->capacity = newReplay->header.frameCount;
+
+                    // Truncated recordings play back as far as they go
+                    const int readSize = pd->file->read(replayFile, newReplay->frames, dataSize);
+                    newReplay->header.frameCount = readSize > 0 ? readSize / sizeof(ReplayFrame) : 0u;
+                }
+            }
+
+            if (newReplay->header.frameCount == 0u || !newReplay->frames)
+            {
+                pd->system->logToConsole("%s:%i Invalid replay %s", __FILE__, __LINE__, path);
+
+                replay_freeReplay(newReplay);
+                newReplay = NULL;
+            }
+        }
+
+        pd->file->close(replayFile);
+
+        return newReplay;
+    }
+
+    return NULL;
+}
+
+int replay_saveToFile(PlaydateAPI* pd, const Replay* replay, const char* path)
+{
+    SDFile* replayFile = pd->file->open(path, kFileWrite);
+
+    if (replayFile)
+    {
+        const int headerSize    = pd->file->write(replayFile, &replay->header, sizeof(ReplayHeader));
+        const int dataSize      = pd->file->write(replayFile, replay->frames, replay->header.frameCount * sizeof(ReplayFrame));
+
+        pd->file->close(replayFile);
+
+        return headerSize == sizeof(ReplayHeader) && dataSize == (int)(replay->header.frameCount * sizeof(ReplayFrame));
+    }
+
+    return 0;
+}
+
+int replay_record(Replay* replay, const ReplayFrame* frame)
+{
+    if (replay->header.frameCount >= REPLAY_MAX_FRAMES)
+    {
+        return 0;
+    }
+
+    if (replay->header.frameCount == replay->capacity)
+    {
+        // Grow geometrically, a minute at 50Hz fits in the first few reallocations
+        const unsigned int newCapacity  = MIN(replay->capacity ? 2u * replay->capacity : 512u, REPLAY_MAX_FRAMES);
+        ReplayFrame* newFrames          = (ReplayFrame*)realloc(replay->frames, sizeof(ReplayFrame) * newCapacity);
+
+        if (!newFrames)
+        {
+            return 0;
+        }
+
+        replay->frames      = newFrames;
+        replay->capacity    = newCapacity;
+    }
+
+    replay->frames[replay->header.frameCount++] = *frame;
+
+    return 1;
+}
+
+int replay_next(Replay* replay, ReplayFrame* frame)
+{
+    if (replay->cursor >= replay->header.frameCount)
+    {
+        return 0;
+    }
+
+    *frame = replay->frames[replay->cursor++];
+
+    return 1;
+}
+
+ReplayView replay_startView(const Replay* replay)
+{
+    return (ReplayView)
+    {
+        .position   = replay->header.position,
+        .yaw        = replay->header.yaw,
+        .pitch      = replay->header.pitch,
+        .roll       = replay->header.roll
+    };
+}
+
+void replay_stepView(ReplayView* view, const ReplayFrame* frame, const HeightQuery* query)
+{
+    const float dt          = frame->dt;
+    const PDButtons buttons = (PDButtons)frame->buttons;
+
+    const float cosPhi      = cosf(view->yaw);
+    const float sinPhi      = sinf(view->yaw);
+
+    if (buttons & kButtonLeft)
+    {
+        view->roll -= REPLAY_ROLL_SPEED * dt;
+        view->yaw  += REPLAY_Y_SPEED * dt * MAX(-view->roll / 45.0f, 0.0f);
+    }
+
+    if (buttons & kButtonRight)
+    {
+        view->roll += REPLAY_ROLL_SPEED * dt;
+        view->yaw  -= REPLAY_Y_SPEED * dt * MAX(view->roll / 45.0f, 0.0f);
+    }
+
+    // Clamp + decay
+    {
+        view->roll = CLAMP(view->roll, -45.0f, 45.0f);
+        view->roll = LERP(view->roll, 0.0f, 0.5f * dt);
+    }
+
+    if (buttons & kButtonUp)
+    {
+        view->position.x -= sinPhi * REPLAY_XZ_SPEED * dt;
+        view->position.z -= cosPhi * REPLAY_XZ_SPEED * dt;
+    }
+
+    if (buttons & kButtonDown)
+    {
+        view->position.x += sinPhi * REPLAY_XZ_SPEED * dt;
+        view->position.z += cosPhi * REPLAY_XZ_SPEED * dt;
+    }
+
+    // Constant forward motion
+    {
+        view->position.x -= sinPhi * REPLAY_XZ_SPEED * dt;
+        view->position.z -= cosPhi * REPLAY_XZ_SPEED * dt;
+    }
+
+    if (buttons & kButtonB)
+    {
+        view->position.y -= REPLAY_Y_SPEED * dt;
+
+        if (view->position.y < 0.0f)
+        {
+            view->position.y = 0.0f;
+        }
+    }
+
+    if (buttons & kButtonA)
+    {
+        view->position.y += REPLAY_Y_SPEED * dt;
+    }
+
+    view->pitch += frame->crankChange / 360.0f;
+
+    // Keep the view above the ground
+    {
+        const float ground = terrain_query_getHeightAtLinear(query, view->position.x, view->position.z) + REPLAY_GROUND_CLEARANCE;
+
+        if (view->position.y < ground)
+        {
+            view->position.y = ground;
+        }
+    }
+}
+
+const struct replay_api replay = {
+
+    .newReplay      = &replay_newReplay,
+    .loadFromFile   = &replay_loadFromFile,
+    .saveToFile     = &replay_saveToFile,
+    .freeReplay     = &replay_freeReplay,
+
+    .record         = &replay_record,
+    .next           = &replay_next,
+
+    .startView      = &replay_startView,
+    .stepView       = &replay_stepView
+};
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "terrain_query.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <float.h>
+
+static inline uint8_t terrain_query_getLevel(const HeightQuery* query, const unsigned int level, const unsigned int x, const unsigned int y)
+{
+    if (level == 0u)
+    {
+        return query->heightmap->data[x + y * query->heightmap->stride].height;
+    }
+
+    return query->levels[level][x + y * query->widths[level]];
+}
+
+HeightQuery* terrain_query_new(const HeightMap* heightmap)
+{
+    HeightQuery* newQuery = (HeightQuery*)malloc(sizeof(HeightQuery));
+
+    if (newQuery)
+    {
+        newQuery->heightmap     = heightmap;
+        newQuery->levels[0]     = NULL;
+        newQuery->widths[0]     = heightmap->width;
+        newQuery->heights[0]    = heightmap->height;
+        newQuery->levelCount    = 1u;
+
+        // Build each level from the previous one, odd sizes round up so the last row/column covers fewer samples
+        while (newQuery->levelCount < QUERY_MAX_LEVELS && (newQuery->widths[newQuery->levelCount - 1u] > 1u || newQuery->heights[newQuery->levelCount - 1u] > 1u))
+        {
+            const unsigned int src          = newQuery->levelCount - 1u;
+            const unsigned int dst          = newQuery->levelCount;
+            const unsigned int srcWidth     = newQuery->widths[src];
+            const unsigned int srcHeight    = newQuery->heights[src];
+            const unsigned int dstWidth     = (srcWidth  + 1u) / 2u;
+            const unsigned int dstHeight    = (srcHeight + 1u) / 2u;
+
+            newQuery->levels[dst] = (uint8_t*)malloc(sizeof(uint8_t) * dstWidth * dstHeight);
+
+            if (!newQuery->levels[dst])
+            {
+                break;
+            }
+
+            newQuery->widths[dst]   = dstWidth;
+            newQuery->heights[dst]  = dstHeight;
+
+            for (unsigned int y = 0u; y < dstHeight; ++y)
+            {
+                for (unsigned int x = 0u; x < dstWidth; ++x)
+                {
+                    const unsigned int x0   = 2u * x;
+                    const unsigned int y0   = 2u * y;
+                    const unsigned int x1   = MIN(x0 + 1u, srcWidth  - 1u);
+                    const unsigned int y1   = MIN(y0 + 1u, srcHeight - 1u);
+
+                    const uint8_t h00       = terrain_query_getLevel(newQuery, src, x0, y0);
+                    const uint8_t h10       = terrain_query_getLevel(newQuery, src, x1, y0);
+                    const uint8_t h01       = terrain_query_getLevel(newQuery, src, x0, y1);
+                    const uint8_t h11       = terrain_query_getLevel(newQuery, src, x1, y1);
+
+                    newQuery->levels[dst][x + y * dstWidth] = MAX(MAX(h00, h10), MAX(h01, h11));
+                }
+            }
+
+            newQuery->levelCount++;
+        }
+    }
+
+    return newQuery;
+}
+
+void terrain_query_free(HeightQuery* query)
+{
+    for (unsigned int level = 1u; level < query->levelCount; ++level)
+    {
+        free(query->levels[level]);
+    }
+
+    free(query);
+}
+
+float terrain_query_getHeightAt(const HeightQuery* query, const float x, const float z)
+{
+    return query->heightmap->data[voxel_terrain_sampleIndex(&query->heightmap->sampler, (int)floorf(x), (int)floorf(z))].height / 255.0f;
+}
+
+float terrain_query_getHeightAtLinear(const HeightQuery* query, const float x, const float z)
+{
+    const MapSampler* sampler   = &query->heightmap->sampler;
+
+    const int xFloor            = (int)floorf(x);
+    const int zFloor            = (int)floorf(z);
+
+    const float u               = x - xFloor;
+    const float v               = z - zFloor;
+
+    const unsigned int x0       = voxel_terrain_wrap(xFloor,     sampler->width,  sampler->widthMask);
+    const unsigned int x1       = voxel_terrain_wrap(xFloor + 1, sampler->width,  sampler->widthMask);
+    const unsigned int z0       = voxel_terrain_wrap(zFloor,     sampler->height, sampler->heightMask);
+    const unsigned int z1       = voxel_terrain_wrap(zFloor + 1, sampler->height, sampler->heightMask);
+
+    const float h00             = terrain_query_getLevel(query, 0u, x0, z0);
+    const float h10             = terrain_query_getLevel(query, 0u, x1, z0);
+    const float h01             = terrain_query_getLevel(query, 0u, x0, z1);
+    const float h11             = terrain_query_getLevel(query, 0u, x1, z1);
+
+    const float hx0             = LERP(h00, h10, u);
+    const float hx1             = LERP(h01, h11, u);
+
+    return LERP(hx0, hx1, v) / 255.0f;
+}
+
+// Distance along the ray to the exit of the [lower, upper) slab
+static inline float terrain_query_exitT(const float origin, const float direction, const float lower, const float upper)
+{
+    if (direction > 0.0f)
+    {
+        return (upper - origin) / direction;
+    }
+
+    if (direction < 0.0f)
+    {
+        return (lower - origin) / direction;
+    }
+
+    return FLT_MAX;
+}
+
+// Based off : maximum mipmap traversal - skip whole cells the ray stays above, descend into the ones it may hit
+int terrain_query_raycast(const HeightQuery* query, const Vector3* origin, const Vector3* direction, const float maxT, Vector3* hit)
+{
+    const unsigned int width    = query->heightmap->width;
+    const unsigned int height   = query->heightmap->height;
+    const unsigned int topLevel = query->levelCount - 1u;
+
+    unsigned int level          = topLevel;
+    float t                     = 0.0f;
+
+    // Sample the ray is currently in - stepped explicitly so that cells grazed at a corner are not skipped
+    int xFloor                  = (int)floorf(origin->x);
+    int zFloor                  = (int)floorf(origin->z);
+
+    for (unsigned int step = 0u; step < QUERY_MAX_STEPS; ++step)
+    {
+        // Locate the cell in the wrapped map, then bring its bounds back into ray space
+        const int xWrapped      = (int)voxel_terrain_wrap(xFloor, width,  query->heightmap->widthMask);
+        const int zWrapped      = (int)voxel_terrain_wrap(zFloor, height, query->heightmap->heightMask);
+
+        const unsigned int cx   = (unsigned int)xWrapped >> level;
+        const unsigned int cz   = (unsigned int)zWrapped >> level;
+
+        const int cellX0        = (int)(cx << level);
+        const int cellZ0        = (int)(cz << level);
+        const int cellX1        = (int)MIN((cx + 1u) << level, width);
+        const int cellZ1        = (int)MIN((cz + 1u) << level, height);
+
+        const int x0            = xFloor - (xWrapped - cellX0);
+        const int z0            = zFloor - (zWrapped - cellZ0);
+        const int x1            = x0 + (cellX1 - cellX0);
+        const int z1            = z0 + (cellZ1 - cellZ0);
+
+        const float tExitX      = terrain_query_exitT(origin->x, direction->x, (float)x0, (float)x1);
+        const float tExitZ      = terrain_query_exitT(origin->z, direction->z, (float)z0, (float)z1);
+        const float tExit       = MIN(tExitX, tExitZ);
+        const float tEnd        = MIN(tExit, maxT);
+
+        // Lowest point of the ray within the cell
+        const float yEnter      = origin->y + direction->y * t;
+        const float yExit       = origin->y + direction->y * tEnd;
+        const float cellMax     = terrain_query_getLevel(query, level, cx, cz) / 255.0f;
+
+        if (MIN(yEnter, yExit) > cellMax)
+        {
+            if (tExit >= maxT)
+            {
+                return QUERY_MISS;
+            }
+
+            // Miss - step into the neighbouring cell along the exit axis, and try a coarser level again
+            const float x   = origin->x + direction->x * tExit;
+            const float z   = origin->z + direction->z * tExit;
+
+            xFloor          = (tExitX <= tExitZ) ? (direction->x > 0.0f ? x1 : x0 - 1) : CLAMP((int)floorf(x), x0, x1 - 1);
+            zFloor          = (tExitZ <= tExitX) ? (direction->z > 0.0f ? z1 : z0 - 1) : CLAMP((int)floorf(z), z0, z1 - 1);
+
+            t               = tExit;
+            level           = MIN(level + 1u, topLevel);
+            continue;
+        }
+
+        if (level > 0u)
+        {
+            level--;
+            continue;
+        }
+
+        // Hit - either on the side of the column or on its top
+        const float tHit = (yEnter <= cellMax) ? t : (cellMax - origin->y) / direction->y;
+
+        if (hit)
+        {
+            hit->x = origin->x + direction->x * tHit;
+            hit->y = origin->y + direction->y * tHit;
+            hit->z = origin->z + direction->z * tHit;
+        }
+
+        return QUERY_HIT;
+    }
+
+    return QUERY_UNRESOLVED;
+}
+
+void terrain_query_lineOfSight(const HeightQuery* query, const Vector3* from, const Vector3* to, uint8_t* visible, const unsigned int count)
+{
+    for (unsigned int i = 0u; i < count; ++i)
+    {
+        const Vector3 direction = (Vector3)
+        {
+            .x = to[i].x - from[i].x,
+            .y = to[i].y - from[i].y,
+            .z = to[i].z - from[i].z
+        };
+
+        visible[i] = terrain_query_raycast(query, &from[i], &direction, 1.0f, NULL) == QUERY_MISS;
+    }
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 HeightMap* voxel_terrain_newHeightMap(const Bitmap* heightmap, const Bitmap* colourMap, int scale)
 {
@@ -11,9 +12,11 @@ HeightMap* voxel_terrain_newHeightMap(const Bitmap* heightmap, const Bitmap* col
 
     if (newHeightmap)
     {
-        newHeightmap->width   = scale * heightmap->infoHeader.biWidth;
-        newHeightmap->height  = scale * heightmap->infoHeader.biHeight;
-        newHeightmap->data    = (TerrainSample*)malloc(sizeof(TerrainSample) * newHeightmap->width * newHeightmap->height);
+        const unsigned int sourceWidth  = heightmap->infoHeader.biWidth;
+        const unsigned int sourceHeight = abs(heightmap->infoHeader.biHeight);
+
+        newHeightmap->sampler = voxel_terrain_newSampler(scale * sourceWidth, scale * sourceHeight);
+        newHeightmap->data    = (TerrainSample*)malloc(sizeof(TerrainSample) * newHeightmap->stride * newHeightmap->height);
 
         if (newHeightmap->data)
         {
@@ -22,10 +25,10 @@ HeightMap* voxel_terrain_newHeightMap(const Bitmap* heightmap, const Bitmap* col
                 for (unsigned int x = 0; x < newHeightmap->width; ++x)
                 {
                     // Index
-                    const unsigned int dstIndex = x + y * newHeightmap->height;
+                    const unsigned int dstIndex = x + y * newHeightmap->stride;
 
-                    const float xSource = (x / (float)newHeightmap->width)  * heightmap->infoHeader.biWidth;
-                    const float ySource = (y / (float)newHeightmap->height) * heightmap->infoHeader.biHeight;
+                    const float xSource = (x / (float)newHeightmap->width)  * sourceWidth;
+                    const float ySource = (y / (float)newHeightmap->height) * sourceHeight;
 
                     // Height
                     {
@@ -62,9 +65,8 @@ DitherMap* voxel_terrain_newDitherMap(const Bitmap* colourmap)
 
     if (newDithermap)
     {
-        newDithermap->width  = colourmap->infoHeader.biWidth;
-        newDithermap->height = colourmap->infoHeader.biHeight;
-        newDithermap->data   = (uint8_t*)malloc(sizeof(uint8_t) * newDithermap->width * newDithermap->height);
+        newDithermap->sampler = voxel_terrain_newSampler(colourmap->infoHeader.biWidth, abs(colourmap->infoHeader.biHeight));
+        newDithermap->data    = (uint8_t*)malloc(sizeof(uint8_t) * newDithermap->stride * newDithermap->height);
 
         if (newDithermap->data)
         {
@@ -73,7 +75,7 @@ DitherMap* voxel_terrain_newDitherMap(const Bitmap* colourmap)
                 for (unsigned int x = 0; x < newDithermap->width; ++x)
                 {
                     // Index
-                    const unsigned int index    = x + y * newDithermap->height;
+                    const unsigned int index    = x + y * newDithermap->stride;
                     newDithermap->data[index]   = bitmap.getPixel(colourmap, x, y).r;
                 }
             }
@@ -89,43 +91,75 @@ void voxel_terrain_freeDitherMap(DitherMap* dithermap)
     free(dithermap);
 }
 
-TerrainSample voxel_terrain_getSample(const HeightMap* heightmap, int x, int y)
+OcclusionBuffer* voxel_terrain_newOcclusionBuffer(const int width, const int height)
 {
-    // Wrap around
-    x = x % heightmap->width;
-    y = y % heightmap->height;
+    OcclusionBuffer* newOcclusion = (OcclusionBuffer*)malloc(sizeof(OcclusionBuffer));
+
+    if (newOcclusion)
+    {
+        newOcclusion->width     = width;
+        newOcclusion->height    = height;
+        newOcclusion->data      = (uint8_t*)malloc(sizeof(uint8_t) * newOcclusion->width * OCCLUSION_SLICES);
+
+        if (newOcclusion->data)
+        {
+            memset(newOcclusion->data, height, sizeof(uint8_t) * newOcclusion->width * OCCLUSION_SLICES);
+        }
+    }
+
+    return newOcclusion;
+}
+
+void voxel_terrain_freeOcclusionBuffer(OcclusionBuffer* occlusion)
+{
+    free(occlusion->data);
+    free(occlusion);
+}
+
+uint8_t voxel_terrain_getOcclusion(const OcclusionBuffer* occlusion, const int x, const float depth)
+{
+    if (x < 0 || x >= (int)occlusion->width || depth <= occlusion->near)
+    {
+        return (uint8_t)occlusion->height;
+    }
 
-    const unsigned int index = x + y * heightmap->height;
-    return heightmap->data[index];
+    // Invert the quadratic z distribution used when drawing & only consider slices fully in front of 'depth'
+    const float zFactor = sqrtf((depth - occlusion->near) / (float)(occlusion->far - occlusion->near));
+    const int slice     = MIN((int)(zFactor * OCCLUSION_SLICES), (int)OCCLUSION_SLICES) - 1;
+
+    return slice < 0 ? (uint8_t)occlusion->height : occlusion->data[x * OCCLUSION_SLICES + slice];
+}
+
+TerrainSample voxel_terrain_getSample(const HeightMap* heightmap, int x, int y)
+{
+    return heightmap->data[voxel_terrain_sampleIndex(&heightmap->sampler, x, y)];
 }
 
 TerrainSample voxel_terrain_lerpSample(const TerrainSample* lhs, const TerrainSample* rhs, const float factor)
 {
     return (TerrainSample)
     {
-        .height    = lhs->height    + (uint8_t)((rhs->height    - lhs->height)    * factor),
-        .luminance = lhs->luminance + (uint8_t)((rhs->luminance - lhs->luminance) * factor)
+        .height    = (uint8_t)(lhs->height    + (int)((rhs->height    - lhs->height)    * factor)),
+        .luminance = (uint8_t)(lhs->luminance + (int)((rhs->luminance - lhs->luminance) * factor))
     };
 }
 
 TerrainSample voxel_terrain_getSampleLinear(const HeightMap* heightmap, const float x, const float y)
 {
-    int x0 = (int)floorf(x);
-    int x1 = x0 + 1;
-    int y0 = (int)floorf(y);
-    int y1 = y0 + 1;
+    const int xFloor = (int)floorf(x);
+    const int yFloor = (int)floorf(y);
 
-    const float u = x - x0;
-    const float v = y - y0;
+    const float u = x - xFloor;
+    const float v = y - yFloor;
 
     // Wrap around
-    x0 = x0 % heightmap->width;
-    y0 = y0 % heightmap->height;
-    x1 = x1 % heightmap->width;
-    y1 = y1 % heightmap->height;
+    const unsigned int x0           = voxel_terrain_wrap(xFloor,     heightmap->width,  heightmap->widthMask);
+    const unsigned int x1           = voxel_terrain_wrap(xFloor + 1, heightmap->width,  heightmap->widthMask);
+    const unsigned int y0           = voxel_terrain_wrap(yFloor,     heightmap->height, heightmap->heightMask);
+    const unsigned int y1           = voxel_terrain_wrap(yFloor + 1, heightmap->height, heightmap->heightMask);
 
-    const unsigned int row0         = y0 * heightmap->width;
-    const unsigned int row1         = y1 * heightmap->width;
+    const unsigned int row0         = y0 * heightmap->stride;
+    const unsigned int row1         = y1 * heightmap->stride;
 
     const TerrainSample* sample00   = &heightmap->data[x0 + row0];
     const TerrainSample* sample10   = &heightmap->data[x1 + row0];
@@ -141,9 +175,7 @@ TerrainSample voxel_terrain_getSampleLinear(const HeightMap* heightmap, const fl
 
 LCDSolidColor voxel_terrain_dither(const DitherMap* dithermap, const unsigned int x, const unsigned int y, const uint8_t luminance)
 {
-    const int xDither               = x % dithermap->width;
-    const int yDither               = y % dithermap->height;
-    const unsigned char ditherMask  = dithermap->data[xDither + yDither * dithermap->width];
+    const unsigned char ditherMask  = dithermap->data[voxel_terrain_sampleIndex(&dithermap->sampler, x, y)];
 
     return (LCDSolidColor)(luminance >= ditherMask);
 }
@@ -158,30 +190,61 @@ static inline void voxel_terrain_setPixel(uint8_t* bitmapData, const uint16_t ro
 
 static inline void voxel_terrain_drawDither(uint8_t* bitmapData, const uint16_t rowBytes, const DitherMap* dithermap, const unsigned int x, const unsigned int y, const uint8_t luminance)
 {
-    const uint8_t xDither       = x % 32u;                  // (uint8_t)dithermap->width;
-    const uint8_t yDither       = y % 32u;                  // (uint8_t)dithermap->height;
-    const uint8_t srcIndex      = xDither + yDither * 32u;  // (uint8_t)dithermap->width;
+    const unsigned int srcIndex = voxel_terrain_sampleIndex(&dithermap->sampler, x, y);
     const uint8_t ditherMask    = dithermap->data[srcIndex];
 
     voxel_terrain_setPixel(bitmapData, rowBytes, x, y, luminance >= ditherMask);
 }
 
-// Number of samples - adjust to balance quality vs performance
-#define LINE_WIDTH  (8u)
+// Number of samples - adjust to balance quality vs performance, the host benchmarks override these
+#ifndef LINE_WIDTH
+    #define LINE_WIDTH  (8u)
+#endif
+
 #define DEPTH       (2 * 96u)
 
 #define ROLL_ENABLED (1)
 
-// Based off : https://github.com/s-macke/VoxelSpace
-void voxel_terrain_draw(
-    uint8_t* bitmapData, 
-    const uint16_t rowBytes,
-    const DitherMap* dithermap, 
-    const HeightMap* heightmap, 
-    const Vector3* position, 
-    const float yaw, 
-    const float pitch, 
-    const float roll, 
+// Silhouette refinement : raymarch at LINE_WIDTH, then re-raymarch single pixel columns only where neighbouring coarse columns disagree
+#ifndef REFINE_ENABLED
+    #define REFINE_ENABLED  (1)
+#endif
+
+// Smallest gap in pixels between neighbouring coarse columns which is refined - lower is closer to full resolution but costs more
+#define REFINE_THRESHOLD    (3)
+#define MAX_COLUMNS         (LCD_COLUMNS / LINE_WIDTH + 1u)
+
+// Number of z steps per occlusion slice
+#define SLICE_DEPTH         (DEPTH / OCCLUSION_SLICES)
+
+_Static_assert(DEPTH % OCCLUSION_SLICES == 0, "DEPTH must be a multiple of OCCLUSION_SLICES");
+
+// Per-frame precomputed z values, scales, offsets and factors
+typedef struct TerrainFrame
+{
+    float   zScales[DEPTH];
+    int     zOffsets[DEPTH];
+    uint8_t zFades[DEPTH];
+    float   zPositionX[DEPTH];
+    float   zPositionZ[DEPTH];
+    float   zDX[DEPTH];
+    float   zDZ[DEPTH];
+    int     zMaxHeight[DEPTH];
+
+    int     horizon;
+    float   halfWidth;
+    float   rcpHalfWidth;
+    float   roll;
+    int     height;
+} TerrainFrame;
+
+static void voxel_terrain_setupFrame(
+    TerrainFrame* frame,
+    const Vector3* position,
+    const int positionY,
+    const float yaw,
+    const float pitch,
+    const float roll,
     const uint16_t near,
     const uint16_t far,
     const float scaleXZ,
@@ -200,96 +263,417 @@ void voxel_terrain_draw(
     const float dz                  = 1.0f / DEPTH;
 
     // Precompute half width for roll
-    const float halfWidth           = width / 2.0f;
-    const float rcpHalfWidth        = 1.0f / halfWidth;
-    const int positionY             = (position->y * 255);
-
-    // Precompute z values, scales, offsets and factors
-    float zScales[DEPTH];
-    int   zOffsets[DEPTH];
-    uint8_t zFades[DEPTH];
-    float zPositionX[DEPTH];
-    float zPositionZ[DEPTH];
-    float zDX[DEPTH];
-    float zDZ[DEPTH];
-    int   zMaxHeight[DEPTH];
+    frame->horizon                  = horizon;
+    frame->halfWidth                = width / 2.0f;
+    frame->rcpHalfWidth             = 1.0f / frame->halfWidth;
+    frame->roll                     = roll;
+    frame->height                   = height;
 
     for (unsigned int z = 0; z < DEPTH; ++z)
     {
         const float zFactor = dz * z;
         const float zValue  = near + (far - near) * (zFactor * zFactor);
 
-        zScales[z]      = scale / (zValue * 255.0f);
-        zOffsets[z]     = (int)(horizon - zScales[z] * positionY);
-        zFades[z]       = (uint8_t)(255 * (1.0f - powf(zFactor, 8.0f)));
+        frame->zScales[z]       = scale / (zValue * 255.0f);
+        frame->zOffsets[z]      = (int)(horizon - frame->zScales[z] * positionY);
+        frame->zFades[z]        = (uint8_t)(255 * (1.0f - powf(zFactor, 8.0f)));
 
-        zPositionX[z]   = scaleXZ * ((-cosPhi * zValue - sinPhi * zValue) + position->x);
-        zPositionZ[z]   = scaleXZ * (( sinPhi * zValue - cosPhi * zValue) + position->z);
+        frame->zPositionX[z]    = scaleXZ * ((-cosPhi * zValue - sinPhi * zValue) + position->x);
+        frame->zPositionZ[z]    = scaleXZ * (( sinPhi * zValue - cosPhi * zValue) + position->z);
 
-        zDX[z]          = scaleXZ * dxFactor * zValue;
-        zDZ[z]          = scaleXZ * dzFactor * zValue;
+        frame->zDX[z]           = scaleXZ * dxFactor * zValue;
+        frame->zDZ[z]           = scaleXZ * dzFactor * zValue;
 
-        zMaxHeight[z]   = CLAMP(height - (int)(255 * zScales[z] + zOffsets[z]), 0, height - 1);
+        frame->zMaxHeight[z]    = CLAMP(height - (int)(255 * frame->zScales[z] + frame->zOffsets[z]), 0, height - 1);
 
         // When roll is enabled, we need the offset to be relative to '0'
         #if ROLL_ENABLED
-            zOffsets[z] -= horizon;
+            frame->zOffsets[z] -= horizon;
         #endif
     }
+}
+
+// Raymarch a single column front to back, drawing 'lineWidth' pixels wide, and return the new top of the column
+// Drawing only happens above 'minHeight' and from 'startSlice' on, which allows a column to start off from a previously computed coverage
+// When 'slices' is set, the column's coverage is folded into it at the end of each slice
+static uint8_t voxel_terrain_drawColumn(
+    uint8_t* bitmapData,
+    const uint16_t rowBytes,
+    const DitherMap* dithermap,
+    const HeightMap* heightmap,
+    const TerrainFrame* frame,
+    const unsigned int x,
+    const unsigned int lineWidth,
+    const unsigned int startSlice,
+    uint8_t minHeight,
+    uint8_t* slices)
+{
+    const int height            = frame->height;
+    const uint8_t startHeight   = minHeight;
+
+    unsigned int slice          = startSlice;
+    unsigned int sliceEnd       = (startSlice + 1u) * SLICE_DEPTH;
+
+    // Scan front to back + skip early if the theoretical max is occluded
+    for (unsigned int z = startSlice * SLICE_DEPTH; z < DEPTH && (frame->zMaxHeight[z] < minHeight) && (minHeight > 0) ; ++z)
+    {
+        // Sample coordinates, floored like the terrain queries so negative coordinates don't share sample '0'
+        const int sampleX = (int)floorf(x * frame->zDX[z] + frame->zPositionX[z]);
+        const int sampleZ = (int)floorf(x * frame->zDZ[z] + frame->zPositionZ[z]);
+
+        // Sample terrain
+        const TerrainSample sample = voxel_terrain_getSample(heightmap, sampleX, sampleZ);
+
+        // Fade luminance
+        const uint8_t fadeLuminance = 255u;
+        const uint8_t luminance     = (uint8_t)((fadeLuminance * (255u - frame->zFades[z]) + sample.luminance * frame->zFades[z]) / 255u);
+
+        if (luminance != fadeLuminance)
+        {
+            #if ROLL_ENABLED
+                const float relativeX       = (x - frame->halfWidth) * frame->rcpHalfWidth;
+                const int shiftedHorizon    = (int)(relativeX * frame->roll + frame->horizon);
+                const int zRollOffset       = (int)(shiftedHorizon + frame->zOffsets[z]);
+                const int heightOnScreen    = (int)(sample.height * frame->zScales[z] + zRollOffset);
+            #else
+                const int heightOnScreen    = (int)(sample.height * frame->zScales[z] + frame->zOffsets[z]);
+            #endif
+
+            if (heightOnScreen > 0)
+            {
+                // Compute upper and lower bounds of the vertical line
+                const uint8_t top = CLAMP(height - heightOnScreen, 0, height - 1);
+                const uint8_t bot = CLAMP(MIN(minHeight, height), top, height);
+
+                // Draw rectangle with dithering
+                for (uint8_t y = top; y < bot; ++y)
+                {
+                    // Compute the offset for this row
+                    const uint16_t rowOffset = y * rowBytes;
+
+                    for (uint16_t u = 0u; u < lineWidth; ++u)
+                    {
+                        // Optimisation : pass '0' to the rowBytes since we have already offset the bitmap based on the active row
+                        voxel_terrain_drawDither(bitmapData + rowOffset, 0u, dithermap, x + u, y, luminance);
+                    }
+                }
+
+                minHeight = MIN(minHeight, top);
+            }
+        }
+
+        // End of slice
+        if (z + 1u == sliceEnd)
+        {
+            if (slices && minHeight < startHeight)
+            {
+                slices[slice] = MIN(slices[slice], minHeight);
+            }
+
+            ++slice;
+            sliceEnd += SLICE_DEPTH;
+        }
+    }
+
+    // Slices skipped by the early out are covered by the final top
+    if (slices && minHeight < startHeight)
+    {
+        for (; slice < OCCLUSION_SLICES; ++slice)
+        {
+            slices[slice] = MIN(slices[slice], minHeight);
+        }
+    }
+
+    return minHeight;
+}
+
+// Based off : https://github.com/s-macke/VoxelSpace
+void voxel_terrain_draw(
+    uint8_t* bitmapData, 
+    const uint16_t rowBytes,
+    const DitherMap* dithermap, 
+    const HeightMap* heightmap, 
+    const Vector3* position, 
+    const float yaw, 
+    const float pitch, 
+    const float roll, 
+    const uint16_t near,
+    const uint16_t far,
+    const float scaleXZ,
+    const float scale,
+    const int width,
+    const int height,
+    OcclusionBuffer* occlusion)
+{
+    TerrainFrame frame;
+    voxel_terrain_setupFrame(&frame, position, (int)(position->y * 255), yaw, pitch, roll, near, far, scaleXZ, scale, width, height);
+
+    if (occlusion)
+    {
+        // Keep track of the view for layers & billboards
+        occlusion->position = *position;
+        occlusion->yaw      = yaw;
+        occlusion->pitch    = pitch;
+        occlusion->roll     = roll;
+        occlusion->near     = near;
+        occlusion->far      = far;
+        occlusion->scaleXZ  = scaleXZ;
+        occlusion->scale    = scale;
+
+        memset(occlusion->data, height, sizeof(uint8_t) * occlusion->width * OCCLUSION_SLICES);
+    }
+
+    #if REFINE_ENABLED
+        // Coverage buffer : top of each coarse column at the end of each slice, the last slice holds the top after the coarse pass
+        uint8_t coverage[MAX_COLUMNS][OCCLUSION_SLICES];
+        unsigned int columnCount = 0u;
+    #endif
 
     // From left to right
     for (unsigned int x = 0u; x < (unsigned int)width; x += LINE_WIDTH)
     {
+        uint8_t* slices = (occlusion && x < occlusion->width) ? &occlusion->data[x * OCCLUSION_SLICES] : NULL;
+
+        #if REFINE_ENABLED
+            // Coarse slices are kept for refinement even without an occlusion buffer
+            if (columnCount < MAX_COLUMNS)
+            {
+                slices = coverage[columnCount++];
+                memset(slices, height, OCCLUSION_SLICES);
+            }
+        #endif
+
         // Start off at min height
-        uint8_t minHeight = height;
+        voxel_terrain_drawColumn(bitmapData, rowBytes, dithermap, heightmap, &frame, x, LINE_WIDTH, 0u, (uint8_t)height, slices);
+
+        // Coarse columns share the same occlusion
+        for (unsigned int u = 0u; slices && occlusion && u < LINE_WIDTH && x + u < occlusion->width; ++u)
+        {
+            uint8_t* columnSlices = &occlusion->data[(x + u) * OCCLUSION_SLICES];
 
-        // Scan front to back + skip early if the theoretical max is occluded
-        for (unsigned int z = 0u; z < DEPTH && (zMaxHeight[z] < minHeight) && (minHeight > 0) ; ++z)
+            if (columnSlices != slices)
+            {
+                memcpy(columnSlices, slices, OCCLUSION_SLICES);
+            }
+        }
+    }
+
+    #if REFINE_ENABLED
+        // Refine the silhouette between coarse columns which disagree
+        for (unsigned int c = 0u; c + 1u < columnCount; ++c)
         {
-            // Sample coordinates
-            const int sampleX = (int)(x * zDX[z] + zPositionX[z]);
-            const int sampleZ = (int)(x * zDZ[z] + zPositionZ[z]);
+            const uint8_t lhs   = coverage[c][OCCLUSION_SLICES - 1u];
+            const uint8_t rhs   = coverage[c + 1u][OCCLUSION_SLICES - 1u];
+            const uint8_t upper = MIN(lhs, rhs);
+            const uint8_t lower = MAX(lhs, rhs);
+
+            if (lower - upper < REFINE_THRESHOLD)
+            {
+                continue;
+            }
+
+            // Neither neighbour reaches above 'lower' before one of them does, so fine columns skip the slices in front of the nearer one
+            unsigned int startSlice = 0u;
 
-            // Sample terrain
-            const TerrainSample sample = voxel_terrain_getSample(heightmap, sampleX, sampleZ);
+            while (coverage[c][startSlice] > lower && coverage[c + 1u][startSlice] > lower)
+            {
+                ++startSlice;
+            }
 
-            // Fade luminance
-            const uint8_t fadeLuminance = 255u;
-            const uint8_t luminance     = (uint8_t)((fadeLuminance * (255u - zFades[z]) + sample.luminance * zFades[z]) / 255u);
+            const unsigned int x0 = c * LINE_WIDTH;
 
-            if (luminance != fadeLuminance)
+            for (unsigned int u = 1u; u < LINE_WIDTH && x0 + u < (unsigned int)width; ++u)
             {
-                #if ROLL_ENABLED
-                    const float relativeX       = (x - halfWidth) * rcpHalfWidth;
-                    const int shiftedHorizon    = (int)(relativeX * roll + horizon);
-                    const int zRollOffset       = (int)(shiftedHorizon + zOffsets[z]);
-                    const int heightOnScreen    = (int)(sample.height * zScales[z] + zRollOffset);
-                #else
-                    const int heightOnScreen    = (int)(sample.height * zScales[z] + zOffsets[z]);
-                #endif
-
-                if (heightOnScreen > 0)
+                uint8_t* slices = (occlusion && x0 + u < occlusion->width) ? &occlusion->data[(x0 + u) * OCCLUSION_SLICES] : NULL;
+
+                // Clear the disputed span, the coarse result below 'lower' is kept as-is
+                for (uint8_t y = upper; y < lower; ++y)
                 {
-                    // Compute upper and lower bounds of the vertical line
-                    const uint8_t top = CLAMP(height - heightOnScreen, 0, height - 1);
-                    const uint8_t bot = CLAMP(MIN(minHeight, height), top, height);
+                    voxel_terrain_setPixel(bitmapData, rowBytes, x0 + u, y, kColorWhite);
+                }
 
-                    // Draw rectangle with dithering
-                    for (uint8_t y = top; y < bot; ++y)
-                    {
-                        // Compute the offset for this row
-                        const uint16_t rowOffset = y * rowBytes;
-
-                        for (uint16_t u = 0u; u < LINE_WIDTH; ++u)
-                        {
-                            // Optimisation : pass '0' to the rowBytes since we have already offset the bitmap based on the active row
-                            voxel_terrain_drawDither(bitmapData + rowOffset, 0u, dithermap, x + u, y, luminance);
-                        }
-                    }
+                // The copied coarse coverage above 'lower' was just cleared, the fine column adds back what it draws
+                for (unsigned int s = 0u; slices && s < OCCLUSION_SLICES; ++s)
+                {
+                    slices[s] = MAX(slices[s], lower);
+                }
+
+                // Fine columns start from the coarse result and only resolve the area above it
+                voxel_terrain_drawColumn(bitmapData, rowBytes, dithermap, heightmap, &frame, x0 + u, 1u, startSlice, lower, slices);
+            }
+        }
+    #endif
+}
+
+// Raymarch a single column of a floating layer front to back - unlike terrain, each sample spans from the layer's base up to its height,
+// so what is already covered is tracked per row rather than with a single top
+static void voxel_terrain_drawLayerColumn(
+    uint8_t* bitmapData,
+    const uint16_t rowBytes,
+    const DitherMap* dithermap,
+    const HeightMap* layer,
+    const TerrainFrame* frame,
+    const unsigned int x,
+    const unsigned int lineWidth,
+    const uint8_t* clip)
+{
+    const int rows              = MIN(frame->height, LCD_ROWS);
 
-                    minHeight = MIN(minHeight, top);
+    uint32_t covered[(LCD_ROWS + 31) / 32];
+    memset(covered, 0, sizeof(covered));
+
+    unsigned int slice          = 0u;
+    unsigned int sliceEnd       = SLICE_DEPTH;
+    int clipHeight              = rows;
+
+    for (unsigned int z = 0u; z < DEPTH; ++z)
+    {
+        // Sample coordinates
+        const int sampleX = (int)floorf(x * frame->zDX[z] + frame->zPositionX[z]);
+        const int sampleZ = (int)floorf(x * frame->zDZ[z] + frame->zPositionZ[z]);
+
+        // Sample layer, '0' is empty
+        const TerrainSample sample = voxel_terrain_getSample(layer, sampleX, sampleZ);
+
+        // Fade luminance
+        const uint8_t fadeLuminance = 255u;
+        const uint8_t luminance     = (uint8_t)((fadeLuminance * (255u - frame->zFades[z]) + sample.luminance * frame->zFades[z]) / 255u);
+
+        if (sample.height > 0 && luminance != fadeLuminance)
+        {
+            #if ROLL_ENABLED
+                const float relativeX       = (x - frame->halfWidth) * frame->rcpHalfWidth;
+                const int shiftedHorizon    = (int)(relativeX * frame->roll + frame->horizon);
+                const int baseOnScreen      = (int)(shiftedHorizon + frame->zOffsets[z]);
+            #else
+                const int baseOnScreen      = frame->zOffsets[z];
+            #endif
+
+            const int heightOnScreen        = (int)(sample.height * frame->zScales[z] + baseOnScreen);
+
+            // Compute upper and lower bounds of the vertical line, below the base is left untouched
+            const int top = CLAMP(frame->height - heightOnScreen, 0, rows);
+            const int bot = CLAMP(frame->height - baseOnScreen, top, clipHeight);
+
+            for (int y = top; y < bot; ++y)
+            {
+                const uint32_t bit = 1u << (y & 31);
+
+                if (covered[y >> 5] & bit)
+                {
+                    continue;
+                }
+
+                covered[y >> 5] |= bit;
+
+                // Compute the offset for this row
+                const uint16_t rowOffset = y * rowBytes;
+
+                for (uint16_t u = 0u; u < lineWidth; ++u)
+                {
+                    voxel_terrain_drawDither(bitmapData + rowOffset, 0u, dithermap, x + u, y, luminance);
                 }
             }
         }
+
+        // Terrain nearer than the next slice
+        if (z + 1u == sliceEnd)
+        {
+            clipHeight = MIN(clip[slice], rows);
+
+            ++slice;
+            sliceEnd += SLICE_DEPTH;
+        }
+    }
+}
+
+void voxel_terrain_drawLayer(
+    uint8_t* bitmapData,
+    const uint16_t rowBytes,
+    const DitherMap* dithermap,
+    const HeightMap* layer,
+    const float altitude,
+    const OcclusionBuffer* occlusion)
+{
+    const int width     = occlusion->width;
+    const int height    = occlusion->height;
+
+    // Raising the layer is the same as lowering the view
+    TerrainFrame frame;
+    voxel_terrain_setupFrame(&frame, &occlusion->position, (int)((occlusion->position.y - altitude) * 255), occlusion->yaw, occlusion->pitch, occlusion->roll, occlusion->near, occlusion->far, occlusion->scaleXZ, occlusion->scale, width, height);
+
+    for (unsigned int x = 0u; x < (unsigned int)width; x += LINE_WIDTH)
+    {
+        voxel_terrain_drawLayerColumn(bitmapData, rowBytes, dithermap, layer, &frame, x, MIN(LINE_WIDTH, width - x), &occlusion->data[x * OCCLUSION_SLICES]);
+    }
+}
+
+void voxel_terrain_drawBillboards(
+    uint8_t* bitmapData,
+    const uint16_t rowBytes,
+    const DitherMap* dithermap,
+    const OcclusionBuffer* occlusion,
+    const Billboard* billboards,
+    const unsigned int count)
+{
+    const int width             = occlusion->width;
+    const int height            = occlusion->height;
+
+    const int horizon           = (int)roundf((1.0f + occlusion->pitch) * (0.5f * height));
+    const float cosPhi          = cosf(occlusion->yaw);
+    const float sinPhi          = sinf(occlusion->yaw);
+    const float halfWidth       = width / 2.0f;
+    const float rcpHalfWidth    = 1.0f / halfWidth;
+    const float rcpScaleXZ      = 1.0f / occlusion->scaleXZ;
+
+    for (unsigned int i = 0u; i < count; ++i)
+    {
+        const Billboard* billboard = &billboards[i];
+
+        // View space - terrain is sampled at 'scaleXZ' times the view space
+        const float dx          = billboard->position.x * rcpScaleXZ - occlusion->position.x;
+        const float dz          = billboard->position.z * rcpScaleXZ - occlusion->position.z;
+        const float zValue      = -sinPhi * dx - cosPhi * dz;
+
+        if (zValue <= occlusion->near || zValue >= occlusion->far)
+        {
+            continue;
+        }
+
+        // Project - inverse of the sampling done when drawing
+        const float rcpZ        = 1.0f / zValue;
+        const float lateral     =  cosPhi * dx - sinPhi * dz;
+        const float screenX     = (lateral * rcpZ + 1.0f) * halfWidth;
+        const float halfSize    = billboard->radius * rcpScaleXZ * rcpZ * halfWidth;
+
+        const int x0            = MAX((int)(screenX - halfSize), 0);
+        const int x1            = MIN((int)(screenX + halfSize) + 1, width);
+
+        if (x0 >= x1)
+        {
+            continue;
+        }
+
+        const float zScale      = occlusion->scale / (zValue * 255.0f);
+        const float baseY       = (billboard->position.y - occlusion->position.y) * 255.0f * zScale;
+        const float topY        = baseY + billboard->height * 255.0f * zScale;
+
+        for (int x = x0; x < x1; ++x)
+        {
+            #if ROLL_ENABLED
+                const int shiftedHorizon = (int)((x - halfWidth) * rcpHalfWidth * occlusion->roll + horizon);
+            #else
+                const int shiftedHorizon = horizon;
+            #endif
+
+            const int occluded  = voxel_terrain_getOcclusion(occlusion, x, zValue);
+            const int top       = CLAMP(height - (int)(topY  + shiftedHorizon), 0, height);
+            const int bot       = CLAMP(height - (int)(baseY + shiftedHorizon), 0, occluded);
+
+            for (int y = top; y < bot; ++y)
+            {
+                voxel_terrain_drawDither(bitmapData + y * rowBytes, 0u, dithermap, x, y, billboard->luminance);
+            }
+        }
     }
-}
\ No newline at end of file
+}
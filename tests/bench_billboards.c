@@ -0,0 +1,81 @@
+#include "test.h"
+
+#include <time.h>
+
+#define BENCH_FRAMES        (300u)
+#define BENCH_BILLBOARDS    (256u)
+#define BENCH_MAP_SIZE      (600u)
+
+// Cost of compositing billboards & a cloud layer against a filled occlusion buffer, on a map the size of the one used on device
+int main(void)
+{
+    uint8_t* frame          = (uint8_t*)malloc(LCD_ROWSIZE * LCD_ROWS);
+    OcclusionBuffer* buffer = voxel_terrain_newOcclusionBuffer(LCD_COLUMNS, LCD_ROWS);
+    HeightMap* heightmap    = test_newHeightMap(BENCH_MAP_SIZE, BENCH_MAP_SIZE);
+    HeightMap* layer        = test_newHeightMap(BENCH_MAP_SIZE, BENCH_MAP_SIZE);
+    Billboard* billboards   = (Billboard*)malloc(sizeof(Billboard) * BENCH_BILLBOARDS);
+
+    DitherMap dithermap;
+    dithermap.sampler       = voxel_terrain_newSampler(32u, 32u);
+    dithermap.data          = (uint8_t*)malloc(32u * 32u);
+
+    for (unsigned int i = 0u; i < 32u * 32u; ++i)
+    {
+        dithermap.data[i] = (uint8_t)test_rand();
+    }
+
+    // Sparse clouds like the ones drawn on device
+    for (unsigned int i = 0u; i < BENCH_MAP_SIZE * BENCH_MAP_SIZE; ++i)
+    {
+        layer->data[i].height = layer->data[i].height > 150u ? (uint8_t)((layer->data[i].height - 150u) / 4u) : 0u;
+    }
+
+    // Billboards standing on the terrain, spread over the half of the map in front of the view
+    const Vector3 position = { BENCH_MAP_SIZE / 2.0f, 1.0f, BENCH_MAP_SIZE / 2.0f };
+
+    for (unsigned int i = 0u; i < BENCH_BILLBOARDS; ++i)
+    {
+        const float x = test_randf() * BENCH_MAP_SIZE;
+        const float z = test_randf() * BENCH_MAP_SIZE / 2.0f;
+
+        billboards[i] = (Billboard)
+        {
+            .position   = { x, voxel_terrain_getSample(heightmap, (int)x, (int)z).height / 255.0f, z },
+            .radius     = 1.5f,
+            .height     = 0.04f,
+            .luminance  = 32u
+        };
+    }
+
+    memset(frame, 0xFF, LCD_ROWSIZE * LCD_ROWS);
+
+    voxel_terrain_draw(frame, LCD_ROWSIZE, &dithermap, heightmap, &position, 0.0f, 0.0f, 0.0f, 1u, BENCH_MAP_SIZE, 1.0f, 20000.0f, LCD_COLUMNS, LCD_ROWS, buffer);
+
+    const clock_t billboardStart = clock();
+
+    for (unsigned int f = 0u; f < BENCH_FRAMES; ++f)
+    {
+        voxel_terrain_drawBillboards(frame, LCD_ROWSIZE, &dithermap, buffer, billboards, BENCH_BILLBOARDS);
+    }
+
+    const clock_t layerStart = clock();
+
+    for (unsigned int f = 0u; f < BENCH_FRAMES; ++f)
+    {
+        voxel_terrain_drawLayer(frame, LCD_ROWSIZE, &dithermap, layer, 1.1f, buffer);
+    }
+
+    const clock_t layerEnd = clock();
+
+    printf("billboards : %u billboards in %.1fus per frame\n", BENCH_BILLBOARDS, 1e6 * (double)(layerStart - billboardStart) / CLOCKS_PER_SEC / BENCH_FRAMES);
+    printf("layer : %.1fus per frame\n", 1e6 * (double)(layerEnd - layerStart) / CLOCKS_PER_SEC / BENCH_FRAMES);
+
+    free(dithermap.data);
+    free(billboards);
+    voxel_terrain_freeHeightMap(layer);
+    voxel_terrain_freeHeightMap(heightmap);
+    voxel_terrain_freeOcclusionBuffer(buffer);
+    free(frame);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+#include "test.h"
+
+#include <time.h>
+
+#define BENCH_FRAMES    (300u)
+#define BENCH_PASSES    (3u)
+
+// Cost of drawing the terrain with the maps & view used on device - built once per renderer configuration
+int main(int argc, char** argv)
+{
+    (void)argc;
+
+    uint8_t* frame          = (uint8_t*)malloc(LCD_ROWSIZE * LCD_ROWS);
+    OcclusionBuffer* buffer = voxel_terrain_newOcclusionBuffer(LCD_COLUMNS, LCD_ROWS);
+    Bitmap* heightBitmap    = bitmap.loadFromFile(&testPlaydate, TEST_IMAGES "D1.bmp");
+    Bitmap* colourBitmap    = bitmap.loadFromFile(&testPlaydate, TEST_IMAGES "C1W.bmp");
+
+    if (!heightBitmap || !colourBitmap)
+    {
+        fprintf(stderr, "Couldn't load the maps from %s\n", TEST_IMAGES);
+        return EXIT_FAILURE;
+    }
+
+    // Same map & scale as on device
+    HeightMap* heightmap    = voxel_terrain_newHeightMap(heightBitmap, colourBitmap, 4);
+
+    bitmap.freeBitmap(heightBitmap);
+    bitmap.freeBitmap(colourBitmap);
+
+    DitherMap dithermap;
+    dithermap.sampler       = voxel_terrain_newSampler(32u, 32u);
+    dithermap.data          = (uint8_t*)malloc(32u * 32u);
+
+    for (unsigned int i = 0u; i < 32u * 32u; ++i)
+    {
+        dithermap.data[i] = (uint8_t)test_rand();
+    }
+
+    // Fly across the map while turning, keep the fastest of a few passes as the host is noisy
+    double best = 0.0;
+
+    for (unsigned int pass = 0u; pass < BENCH_PASSES; ++pass)
+    {
+        const clock_t start = clock();
+
+        for (unsigned int f = 0u; f < BENCH_FRAMES; ++f)
+        {
+            const float x           = heightmap->width  / 2.0f;
+            const float z           = heightmap->height / 2.0f - f * 1.0f;
+            const float ground      = voxel_terrain_getSample(heightmap, (int)floorf(x), (int)floorf(z)).height / 255.0f;
+            const Vector3 position  = { x, MAX(0.5f, ground + 0.05f), z };
+
+            memset(frame, 0xFF, LCD_ROWSIZE * LCD_ROWS);
+
+            voxel_terrain_draw(frame, LCD_ROWSIZE, &dithermap, heightmap, &position, f * 0.01f, 0.0f, 0.0f, 1u, (uint16_t)heightmap->height, 1.0f, 20000.0f, LCD_COLUMNS, LCD_ROWS, buffer);
+        }
+
+        const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        best = (pass == 0u || seconds < best) ? seconds : best;
+    }
+
+    printf("%s : %.3fms per frame\n", argv[0], 1e3 * best / BENCH_FRAMES);
+
+    free(dithermap.data);
+    voxel_terrain_freeHeightMap(heightmap);
+    voxel_terrain_freeOcclusionBuffer(buffer);
+    free(frame);
+
+    return EXIT_SUCCESS;
+}
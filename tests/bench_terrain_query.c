@@ -0,0 +1,47 @@
+#include "test.h"
+#include "terrain_query.h"
+
+#include <time.h>
+
+#define BENCH_QUERIES (100000u)
+
+// Throughput of line of sight queries over a map the size of the one used on device
+int main(void)
+{
+    HeightMap* heightmap    = test_newHeightMap(600u, 600u);
+    HeightQuery* query      = terrain_query_new(heightmap);
+
+    Vector3* from           = (Vector3*)malloc(sizeof(Vector3) * BENCH_QUERIES);
+    Vector3* to             = (Vector3*)malloc(sizeof(Vector3) * BENCH_QUERIES);
+    uint8_t* visible        = (uint8_t*)malloc(sizeof(uint8_t) * BENCH_QUERIES);
+
+    // Views above the terrain looking at points up to a quarter of the map away
+    for (unsigned int i = 0u; i < BENCH_QUERIES; ++i)
+    {
+        from[i] = (Vector3){ test_randf() * 600.0f, 1.0f + test_randf() * 0.5f, test_randf() * 600.0f };
+        to[i]   = (Vector3){ from[i].x + test_randf() * 300.0f - 150.0f, test_randf() * 1.5f, from[i].z + test_randf() * 300.0f - 150.0f };
+    }
+
+    const clock_t start = clock();
+
+    terrain_query_lineOfSight(query, from, to, visible, BENCH_QUERIES);
+
+    const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    unsigned int visibleCount = 0u;
+
+    for (unsigned int i = 0u; i < BENCH_QUERIES; ++i)
+    {
+        visibleCount += visible[i];
+    }
+
+    printf("line of sight : %u queries in %.3fs (%.0f queries/s), %u visible\n", BENCH_QUERIES, seconds, BENCH_QUERIES / (seconds > 0.0 ? seconds : 1e-9), visibleCount);
+
+    free(from);
+    free(to);
+    free(visible);
+    terrain_query_free(query);
+    voxel_terrain_freeHeightMap(heightmap);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,65 @@
+#ifndef PD_API_STUB_HEADER
+#define PD_API_STUB_HEADER
+
+// Minimal stand-in for the Playdate SDK's pd_api.h - only what the host tests need
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define LCD_COLUMNS     400
+#define LCD_ROWS        240
+#define LCD_ROWSIZE     52
+
+typedef enum
+{
+    kColorBlack,
+    kColorWhite,
+    kColorClear,
+    kColorXOR
+} LCDSolidColor;
+
+typedef enum
+{
+    kButtonLeft     = (1 << 0),
+    kButtonRight    = (1 << 1),
+    kButtonUp       = (1 << 2),
+    kButtonDown     = (1 << 3),
+    kButtonB        = (1 << 4),
+    kButtonA        = (1 << 5)
+} PDButtons;
+
+typedef enum
+{
+    kFileRead       = (1 << 0),
+    kFileReadData   = (1 << 1),
+    kFileWrite      = (1 << 2),
+    kFileAppend     = (2 << 2)
+} FileOptions;
+
+typedef void SDFile;
+
+struct playdate_file
+{
+    const char* (*geterr)(void);
+    SDFile* (*open)(const char* name, FileOptions mode);
+    int (*close)(SDFile* file);
+    int (*read)(SDFile* file, void* buf, unsigned int len);
+    int (*write)(SDFile* file, const void* buf, unsigned int len);
+    int (*seek)(SDFile* file, int pos, int whence);
+};
+
+struct playdate_sys
+{
+    void (*logToConsole)(const char* fmt, ...);
+};
+
+typedef struct PlaydateAPI
+{
+    const struct playdate_sys*  system;
+    const struct playdate_file* file;
+} PlaydateAPI;
+
+#endif
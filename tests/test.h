@@ -0,0 +1,106 @@
+#ifndef TEST_HEADER
+#define TEST_HEADER
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "voxel_terrain.h"
+
+// Header statics which not every test or benchmark uses
+#if defined(__GNUC__)
+    #define TEST_UNUSED __attribute__((unused))
+#else
+    #define TEST_UNUSED
+#endif
+
+// Minimal test helpers - each test is an executable which returns non-zero on failure
+static TEST_UNUSED int testFailures = 0;
+
+#define CHECK(CONDITION, ...)                                               \
+    do                                                                      \
+    {                                                                       \
+        if (!(CONDITION))                                                   \
+        {                                                                   \
+            if (testFailures++ < 16)                                        \
+            {                                                               \
+                fprintf(stderr, "%s:%i CHECK(%s) failed : ", __FILE__, __LINE__, #CONDITION); \
+                fprintf(stderr, __VA_ARGS__);                               \
+                fprintf(stderr, "\n");                                      \
+            }                                                               \
+        }                                                                   \
+    } while (0)
+
+#define TEST_RESULT()                                                       \
+    (testFailures ? (fprintf(stderr, "%i check(s) failed\n", testFailures), EXIT_FAILURE) : EXIT_SUCCESS)
+
+// Deterministic random numbers so failures reproduce
+static unsigned int testSeed = 1u;
+
+static inline unsigned int test_rand(void)
+{
+    testSeed = testSeed * 1664525u + 1013904223u;
+    return testSeed >> 8;
+}
+
+static inline float test_randf(void)
+{
+    return (test_rand() & 0xFFFFu) / 65535.0f;
+}
+
+// Playdate API backed by stdio, for the loaders
+static inline SDFile* test_fileOpen(const char* name, FileOptions mode)
+{
+    return fopen(name, (mode & kFileWrite) ? "wb" : "rb");
+}
+
+static inline int test_fileClose(SDFile* file)
+{
+    return fclose((FILE*)file);
+}
+
+static inline int test_fileRead(SDFile* file, void* buf, unsigned int len)
+{
+    return (int)fread(buf, 1, len, (FILE*)file);
+}
+
+static inline int test_fileWrite(SDFile* file, const void* buf, unsigned int len)
+{
+    return (int)fwrite(buf, 1, len, (FILE*)file);
+}
+
+static inline int test_fileSeek(SDFile* file, int pos, int whence)
+{
+    return fseek((FILE*)file, pos, whence);
+}
+
+static inline const char* test_fileError(void)
+{
+    return "";
+}
+
+static inline void test_log(const char* fmt, ...)
+{
+    (void)fmt;
+}
+
+static const struct playdate_file testFile      = { test_fileError, test_fileOpen, test_fileClose, test_fileRead, test_fileWrite, test_fileSeek };
+static const struct playdate_sys testSystem     = { test_log };
+static TEST_UNUSED PlaydateAPI testPlaydate     = { &testSystem, &testFile };
+
+// Height map filled with random heights & luminances, luminance stays below 255 so every sample is drawn
+static inline HeightMap* test_newHeightMap(const unsigned int width, const unsigned int height)
+{
+    HeightMap* heightmap    = (HeightMap*)malloc(sizeof(HeightMap));
+    heightmap->sampler      = voxel_terrain_newSampler(width, height);
+    heightmap->data         = (TerrainSample*)malloc(sizeof(TerrainSample) * width * height);
+
+    for (unsigned int i = 0u; i < width * height; ++i)
+    {
+        heightmap->data[i].height       = (uint8_t)(test_rand() % 256u);
+        heightmap->data[i].luminance    = (uint8_t)(test_rand() % 255u);
+    }
+
+    return heightmap;
+}
+
+#endif
@@ -0,0 +1,75 @@
+#include "test.h"
+#include "bitmap.h"
+
+#define BITMAP_PATH "test_bitmap.bmp"
+
+// Write a 24 bit bitmap where each pixel encodes its own coordinates
+static void writeBitmap(const unsigned int width, const int height)
+{
+    const unsigned int rows     = abs(height);
+    const unsigned int padding  = (4u - (width * 3u) % 4u) % 4u;
+    const unsigned int dataSize = (width * 3u + padding) * rows;
+
+    const BitmapFileHeader fileHeader = { .bfType = 0x4D42, .bfSize = sizeof(BitmapFileHeader) + sizeof(BitmapInfoHeader) + dataSize, .bfOffBits = sizeof(BitmapFileHeader) + sizeof(BitmapInfoHeader) };
+    const BitmapInfoHeader infoHeader = { .biSize = sizeof(BitmapInfoHeader), .biWidth = width, .biHeight = height, .biPlanes = 1, .biBitCount = 24, .biSizeImage = dataSize };
+
+    FILE* file = fopen(BITMAP_PATH, "wb");
+    fwrite(&fileHeader, sizeof(fileHeader), 1, file);
+    fwrite(&infoHeader, sizeof(infoHeader), 1, file);
+
+    for (unsigned int row = 0u; row < rows; ++row)
+    {
+        // Bottom-up bitmaps store the last row first
+        const unsigned int y = height < 0 ? row : rows - row - 1u;
+
+        for (unsigned int x = 0u; x < width; ++x)
+        {
+            const BitmapPixel pixel = { .b = (unsigned char)x, .g = (unsigned char)y, .r = 0x7F };
+            fwrite(&pixel, sizeof(pixel), 1, file);
+        }
+
+        const unsigned char pad[3] = { 0, 0, 0 };
+        fwrite(pad, 1, padding, file);
+    }
+
+    fclose(file);
+}
+
+static void testLoad(const unsigned int width, const int height)
+{
+    writeBitmap(width, height);
+
+    Bitmap* loaded = bitmap.loadFromFile(&testPlaydate, BITMAP_PATH);
+    CHECK(loaded && loaded->data, "%ux%i bitmap failed to load", width, height);
+
+    if (loaded && loaded->data)
+    {
+        for (unsigned int y = 0u; y < (unsigned int)abs(height); ++y)
+        {
+            for (unsigned int x = 0u; x < width; ++x)
+            {
+                const BitmapPixel pixel = bitmap.getPixel(loaded, x, y);
+                CHECK(pixel.b == x && pixel.g == y && pixel.r == 0x7F, "%ux%i bitmap pixel %u %u", width, height, x, y);
+            }
+        }
+    }
+
+    if (loaded)
+    {
+        bitmap.freeBitmap(loaded);
+    }
+
+    remove(BITMAP_PATH);
+}
+
+int main(void)
+{
+    // Every padding amount, both bottom-up & top-down
+    for (unsigned int width = 1u; width <= 4u; ++width)
+    {
+        testLoad(width + 20u,  7);
+        testLoad(width + 20u, -7);
+    }
+
+    return TEST_RESULT();
+}
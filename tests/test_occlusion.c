@@ -0,0 +1,182 @@
+#include "test.h"
+
+#define FRAME_SIZE (LCD_ROWSIZE * LCD_ROWS)
+
+// Dither map which draws every terrain pixel black, so the frame shows exactly what was covered
+static DitherMap* newBlackDitherMap(void)
+{
+    DitherMap* dithermap    = (DitherMap*)malloc(sizeof(DitherMap));
+    dithermap->sampler      = voxel_terrain_newSampler(32u, 32u);
+    dithermap->data         = (uint8_t*)malloc(32u * 32u);
+
+    memset(dithermap->data, 255, 32u * 32u);
+
+    return dithermap;
+}
+
+static int isBlack(const uint8_t* frame, const unsigned int x, const unsigned int y)
+{
+    return !(frame[(x >> 3) + y * LCD_ROWSIZE] & (1u << (7u - (x & 7u))));
+}
+
+// Topmost covered row of each column must be what the occlusion buffer reports once all slices are considered
+static void testMatchesFrame(const unsigned int width, const unsigned int height, const unsigned int views)
+{
+    uint8_t* frame          = (uint8_t*)malloc(FRAME_SIZE);
+    OcclusionBuffer* buffer = voxel_terrain_newOcclusionBuffer(LCD_COLUMNS, LCD_ROWS);
+    DitherMap* dithermap    = newBlackDitherMap();
+    HeightMap* heightmap    = test_newHeightMap(width, height);
+
+    for (unsigned int v = 0u; v < views; ++v)
+    {
+        const Vector3 position  = { test_randf() * width, 0.2f + test_randf() * 1.2f, test_randf() * height };
+        const float yaw         = test_randf() * 7.0f - 3.5f;
+        const float pitch       = test_randf() - 0.5f;
+        const float roll        = test_randf() * 90.0f - 45.0f;
+
+        memset(frame, 0xFF, FRAME_SIZE);
+
+        voxel_terrain_draw(frame, LCD_ROWSIZE, dithermap, heightmap, &position, yaw, pitch, roll, 1u, (uint16_t)width, 1.0f, 20000.0f, LCD_COLUMNS, LCD_ROWS, buffer);
+
+        for (unsigned int x = 0u; x < LCD_COLUMNS; ++x)
+        {
+            unsigned int top = LCD_ROWS;
+
+            for (unsigned int y = 0u; y < LCD_ROWS && top == LCD_ROWS; ++y)
+            {
+                top = isBlack(frame, x, y) ? y : top;
+            }
+
+            const uint8_t occluded = buffer->data[x * OCCLUSION_SLICES + OCCLUSION_SLICES - 1u];
+
+            CHECK(occluded == top, "map %ux%u view %u column %u : occlusion %u, frame %u", width, height, v, x, occluded, top);
+
+            // Slices only ever cover more with depth
+            for (unsigned int s = 1u; s < OCCLUSION_SLICES; ++s)
+            {
+                CHECK(buffer->data[x * OCCLUSION_SLICES + s] <= buffer->data[x * OCCLUSION_SLICES + s - 1u], "column %u slice %u", x, s);
+            }
+        }
+    }
+
+    voxel_terrain_freeHeightMap(heightmap);
+    free(dithermap->data);
+    free(dithermap);
+    voxel_terrain_freeOcclusionBuffer(buffer);
+    free(frame);
+}
+
+// A layer above the view is only visible above the horizon, it must not draw a curtain down to the terrain
+static void testLayerHasBottom(void)
+{
+    uint8_t* frame          = (uint8_t*)malloc(FRAME_SIZE);
+    OcclusionBuffer* buffer = voxel_terrain_newOcclusionBuffer(LCD_COLUMNS, LCD_ROWS);
+    DitherMap* dithermap    = newBlackDitherMap();
+    HeightMap* ground       = test_newHeightMap(256u, 256u);
+    HeightMap* layer        = test_newHeightMap(256u, 256u);
+
+    for (unsigned int i = 0u; i < 256u * 256u; ++i)
+    {
+        ground->data[i].height  = 0u;
+        layer->data[i].height   = (i % 3u) ? 0u : (uint8_t)(1u + i % 40u);
+    }
+
+    const Vector3 position = { 128.0f, 0.5f, 128.0f };
+
+    voxel_terrain_draw(frame, LCD_ROWSIZE, dithermap, ground, &position, 0.3f, 0.0f, 0.0f, 1u, 256u, 1.0f, 20000.0f, LCD_COLUMNS, LCD_ROWS, buffer);
+
+    memset(frame, 0xFF, FRAME_SIZE);
+
+    voxel_terrain_drawLayer(frame, LCD_ROWSIZE, dithermap, layer, 0.8f, buffer);
+
+    unsigned int drawn = 0u;
+
+    for (unsigned int y = 0u; y < LCD_ROWS; ++y)
+    {
+        for (unsigned int x = 0u; x < LCD_COLUMNS; ++x)
+        {
+            drawn += isBlack(frame, x, y);
+
+            CHECK(y < LCD_ROWS / 2u || !isBlack(frame, x, y), "layer drawn below the horizon at %u %u", x, y);
+        }
+    }
+
+    CHECK(drawn > 0u, "layer not drawn");
+
+    voxel_terrain_freeHeightMap(layer);
+    voxel_terrain_freeHeightMap(ground);
+    free(dithermap->data);
+    free(dithermap);
+    voxel_terrain_freeOcclusionBuffer(buffer);
+    free(frame);
+}
+
+// A billboard behind a nearer ridge is drawn down to the ridge and no further
+static void testBillboardBehindRidge(void)
+{
+    uint8_t* frame          = (uint8_t*)malloc(FRAME_SIZE);
+    OcclusionBuffer* buffer = voxel_terrain_newOcclusionBuffer(LCD_COLUMNS, LCD_ROWS);
+    DitherMap* dithermap    = newBlackDitherMap();
+    HeightMap* heightmap    = test_newHeightMap(256u, 256u);
+
+    // Flat ground with a ridge across the view, 16 to 24 samples ahead
+    for (unsigned int z = 0u; z < 256u; ++z)
+    {
+        for (unsigned int x = 0u; x < 256u; ++x)
+        {
+            heightmap->data[x + z * 256u].height = (z >= 104u && z < 112u) ? 90u : 0u;
+        }
+    }
+
+    const Vector3 position      = { 128.0f, 0.3f, 128.0f };
+    const Billboard billboard   = { .position = { 128.0f, 0.0f, 68.0f }, .radius = 8.0f, .height = 1.0f, .luminance = 0u };
+
+    voxel_terrain_draw(frame, LCD_ROWSIZE, dithermap, heightmap, &position, 0.0f, 0.0f, 0.0f, 1u, 256u, 1.0f, 20000.0f, LCD_COLUMNS, LCD_ROWS, buffer);
+
+    memset(frame, 0xFF, FRAME_SIZE);
+
+    voxel_terrain_drawBillboards(frame, LCD_ROWSIZE, dithermap, buffer, &billboard, 1u);
+
+    unsigned int columns = 0u;
+
+    for (unsigned int x = 0u; x < LCD_COLUMNS; ++x)
+    {
+        unsigned int bottom = 0u;
+
+        for (unsigned int y = 0u; y < LCD_ROWS; ++y)
+        {
+            bottom = isBlack(frame, x, y) ? y + 1u : bottom;
+        }
+
+        if (bottom == 0u)
+        {
+            continue;
+        }
+
+        const uint8_t occluded = voxel_terrain_getOcclusion(buffer, (int)x, 60.0f);
+
+        CHECK(occluded < LCD_ROWS / 2u, "column %u : ridge doesn't occlude the billboard (%u)", x, occluded);
+        CHECK(bottom == occluded, "column %u : billboard drawn down to %u, occluded from %u", x, bottom, occluded);
+
+        ++columns;
+    }
+
+    CHECK(columns > 0u, "billboard not drawn");
+
+    voxel_terrain_freeHeightMap(heightmap);
+    free(dithermap->data);
+    free(dithermap);
+    voxel_terrain_freeOcclusionBuffer(buffer);
+    free(frame);
+}
+
+int main(void)
+{
+    testMatchesFrame(1024u, 1024u, 20u);
+    testMatchesFrame(600u, 600u, 20u);
+    testMatchesFrame(97u, 311u, 20u);
+    testLayerHasBottom();
+    testBillboardBehindRidge();
+
+    return TEST_RESULT();
+}
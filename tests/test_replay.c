@@ -0,0 +1,219 @@
+#include "test.h"
+#include "replay.h"
+
+#define REPLAY_TEST_PATH "test_replay.bin"
+
+static void writeFile(const void* data, const size_t size)
+{
+    FILE* file = fopen(REPLAY_TEST_PATH, "wb");
+    fwrite(data, 1, size, file);
+    fclose(file);
+}
+
+static void testRoundTrip(void)
+{
+    const Vector3 position  = { 1.0f, 0.5f, -3.0f };
+    Replay* recording       = replay.newReplay(&position, 0.25f, -0.1f, 12.0f);
+
+    for (unsigned int i = 0u; i < 2000u; ++i)
+    {
+        const ReplayFrame frame = { .dt = i * 0.001f, .crankChange = (float)i, .buttons = (uint8_t)(i & 0x3Fu) };
+        CHECK(replay.record(recording, &frame), "record frame %u", i);
+    }
+
+    CHECK(replay.saveToFile(&testPlaydate, recording, REPLAY_TEST_PATH), "save");
+    replay.freeReplay(recording);
+
+    Replay* playback = replay.loadFromFile(&testPlaydate, REPLAY_TEST_PATH);
+    CHECK(playback != NULL, "load");
+
+    if (playback)
+    {
+        CHECK(playback->header.position.z == -3.0f && playback->header.yaw == 0.25f && playback->header.roll == 12.0f, "start view");
+
+        ReplayFrame frame;
+        unsigned int count = 0u;
+
+        while (replay.next(playback, &frame))
+        {
+            CHECK(frame.dt == count * 0.001f && frame.crankChange == (float)count && frame.buttons == (count & 0x3Fu), "frame %u", count);
+            count++;
+        }
+
+        CHECK(count == 2000u, "played %u frames", count);
+        replay.freeReplay(playback);
+    }
+
+    remove(REPLAY_TEST_PATH);
+}
+
+static void testRejectsInvalid(void)
+{
+    const ReplayFrame frames[4] = { { 0 } };
+    const ReplayHeader valid    = { .magic = REPLAY_MAGIC, .version = REPLAY_VERSION, .frameCount = 4u };
+
+    struct
+    {
+        ReplayHeader    header;
+        ReplayFrame     frames[4];
+    } file;
+
+    file.header = valid;
+    memcpy(file.frames, frames, sizeof(frames));
+
+    // Bad magic, bad version, oversized & empty frame counts, missing frames, truncated header
+    file.header.magic = 0u;
+    writeFile(&file, sizeof(file));
+    CHECK(replay.loadFromFile(&testPlaydate, REPLAY_TEST_PATH) == NULL, "bad magic");
+
+    file.header         = valid;
+    file.header.version = REPLAY_VERSION + 1u;
+    writeFile(&file, sizeof(file));
+    CHECK(replay.loadFromFile(&testPlaydate, REPLAY_TEST_PATH) == NULL, "bad version");
+
+    file.header             = valid;
+    file.header.frameCount  = 0xFFFFFFFFu;
+    writeFile(&file, sizeof(file));
+    CHECK(replay.loadFromFile(&testPlaydate, REPLAY_TEST_PATH) == NULL, "oversized frame count");
+
+    file.header.frameCount  = 0u;
+    writeFile(&file, sizeof(file));
+    CHECK(replay.loadFromFile(&testPlaydate, REPLAY_TEST_PATH) == NULL, "empty frame count");
+
+    file.header = valid;
+    writeFile(&file, sizeof(ReplayHeader));
+    CHECK(replay.loadFromFile(&testPlaydate, REPLAY_TEST_PATH) == NULL, "missing frames");
+
+    writeFile(&file, sizeof(ReplayHeader) / 2u);
+    CHECK(replay.loadFromFile(&testPlaydate, REPLAY_TEST_PATH) == NULL, "truncated header");
+
+    // Truncated frames play back as far as they go
+    writeFile(&file, sizeof(ReplayHeader) + 2u * sizeof(ReplayFrame) + 1u);
+    Replay* truncated = replay.loadFromFile(&testPlaydate, REPLAY_TEST_PATH);
+    CHECK(truncated && truncated->header.frameCount == 2u, "truncated frames");
+
+    if (truncated)
+    {
+        replay.freeReplay(truncated);
+    }
+
+    CHECK(replay.loadFromFile(&testPlaydate, "missing_replay.bin") == NULL, "missing file");
+
+    remove(REPLAY_TEST_PATH);
+}
+
+// Play a recording back from its start view, and return where it ends
+static ReplayView playBack(const char* path, const HeightQuery* query)
+{
+    Replay* playback    = replay.loadFromFile(&testPlaydate, path);
+    ReplayView view     = { { 0.0f, 0.0f, 0.0f }, 0.0f, 0.0f, 0.0f };
+
+    CHECK(playback != NULL, "load %s", path);
+
+    if (playback)
+    {
+        ReplayFrame frame;
+        view = replay.startView(playback);
+
+        while (replay.next(playback, &frame))
+        {
+            replay.stepView(&view, &frame, query);
+        }
+
+        replay.freeReplay(playback);
+    }
+
+    return view;
+}
+
+// Playing the same recording back twice must end at exactly the same view
+static void testPlaybackReproducible(const char* path, const HeightQuery* query)
+{
+    const ReplayView first  = playBack(path, query);
+    const ReplayView second = playBack(path, query);
+
+    CHECK(memcmp(&first, &second, sizeof(ReplayView)) == 0, "%s : (%f %f %f) then (%f %f %f)", path,
+        first.position.x, first.position.y, first.position.z, second.position.x, second.position.y, second.position.z);
+
+    printf("%s : ends at x=%f y=%f z=%f yaw=%f pitch=%f roll=%f\n", path, first.position.x, first.position.y, first.position.z, first.yaw, first.pitch, first.roll);
+}
+
+// Record a minute of varied input, the view has to move & stay above the terrain
+static void testRecordedPlayback(void)
+{
+    HeightMap* heightmap    = test_newHeightMap(256u, 256u);
+    HeightQuery* query      = terrain_query_new(heightmap);
+
+    const Vector3 position  = { 128.0f, 0.5f, 128.0f };
+    Replay* recording       = replay.newReplay(&position, 0.0f, 0.0f, 0.0f);
+    ReplayView live         = replay.startView(recording);
+
+    for (unsigned int i = 0u; i < 3000u; ++i)
+    {
+        const ReplayFrame frame = { .dt = 0.015f + 0.01f * test_randf(), .crankChange = test_randf() - 0.5f, .buttons = (uint8_t)((i / 50u) * 7u % 64u) };
+
+        replay.record(recording, &frame);
+        replay.stepView(&live, &frame, query);
+    }
+
+    CHECK(replay.saveToFile(&testPlaydate, recording, REPLAY_TEST_PATH), "save");
+    replay.freeReplay(recording);
+
+    const ReplayView played = playBack(REPLAY_TEST_PATH, query);
+
+    CHECK(memcmp(&live, &played, sizeof(ReplayView)) == 0, "live (%f %f %f), played back (%f %f %f)",
+        live.position.x, live.position.y, live.position.z, played.position.x, played.position.y, played.position.z);
+    CHECK(played.position.x != position.x || played.position.z != position.z, "view didn't move");
+    CHECK(played.position.y >= terrain_query_getHeightAtLinear(query, played.position.x, played.position.z), "view below the terrain");
+
+    testPlaybackReproducible(REPLAY_TEST_PATH, query);
+
+    remove(REPLAY_TEST_PATH);
+    terrain_query_free(query);
+    voxel_terrain_freeHeightMap(heightmap);
+}
+
+// Replay a recording made on device against the maps used on device
+static void testDevicePlayback(const char* path)
+{
+    Bitmap* heightBitmap    = bitmap.loadFromFile(&testPlaydate, TEST_IMAGES "D1.bmp");
+    Bitmap* colourBitmap    = bitmap.loadFromFile(&testPlaydate, TEST_IMAGES "C1W.bmp");
+
+    CHECK(heightBitmap && colourBitmap, "load maps from %s", TEST_IMAGES);
+
+    if (heightBitmap && colourBitmap)
+    {
+        HeightMap* heightmap    = voxel_terrain_newHeightMap(heightBitmap, colourBitmap, 4);
+        HeightQuery* query      = terrain_query_new(heightmap);
+
+        testPlaybackReproducible(path, query);
+
+        terrain_query_free(query);
+        voxel_terrain_freeHeightMap(heightmap);
+    }
+
+    if (heightBitmap)
+    {
+        bitmap.freeBitmap(heightBitmap);
+    }
+
+    if (colourBitmap)
+    {
+        bitmap.freeBitmap(colourBitmap);
+    }
+}
+
+// Usage : test_replay [replay.bin] - a recording from the device's data folder is replayed against the device maps
+int main(int argc, char** argv)
+{
+    testRoundTrip();
+    testRejectsInvalid();
+    testRecordedPlayback();
+
+    if (argc > 1)
+    {
+        testDevicePlayback(argv[1]);
+    }
+
+    return TEST_RESULT();
+}
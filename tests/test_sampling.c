@@ -0,0 +1,167 @@
+#include "test.h"
+#include "terrain_query.h"
+
+// Guard bytes after the frame buffer to catch out of bounds writes
+#define FRAME_SIZE  (LCD_ROWSIZE * LCD_ROWS)
+#define GUARD_SIZE  (64u)
+#define GUARD_VALUE (0xA5u)
+
+static unsigned int referenceWrap(const int value, const unsigned int size)
+{
+    const long long wrapped = (long long)value % (long long)size;
+    return (unsigned int)(wrapped < 0 ? wrapped + size : wrapped);
+}
+
+static unsigned int randomSize(void)
+{
+    // Half power of two sizes to cover the masked path
+    return (test_rand() & 1u) ? (1u << (test_rand() % 11u)) : 1u + test_rand() % 700u;
+}
+
+static void testWrap(void)
+{
+    for (unsigned int i = 0u; i < 100000u; ++i)
+    {
+        const unsigned int size     = randomSize();
+        const MapSampler sampler    = voxel_terrain_newSampler(size, 1u);
+        const int value             = (int)(test_rand() << 8) ^ (int)test_rand();
+
+        CHECK(voxel_terrain_wrap(value, sampler.width, sampler.widthMask) == referenceWrap(value, size), "wrap %i into %u", value, size);
+    }
+}
+
+static void testSamples(void)
+{
+    for (unsigned int m = 0u; m < 64u; ++m)
+    {
+        HeightMap* heightmap = test_newHeightMap(randomSize(), randomSize());
+
+        for (unsigned int i = 0u; i < 1000u; ++i)
+        {
+            const int x = (int)(test_rand() % 200000u) - 100000;
+            const int y = (int)(test_rand() % 200000u) - 100000;
+
+            const unsigned int index        = referenceWrap(x, heightmap->width) + referenceWrap(y, heightmap->height) * heightmap->width;
+            const TerrainSample sample      = voxel_terrain_getSample(heightmap, x, y);
+            const TerrainSample expected    = heightmap->data[index];
+
+            CHECK(sample.height == expected.height && sample.luminance == expected.luminance, "map %ux%u sample %i %i", heightmap->width, heightmap->height, x, y);
+
+            // Filtered samples stay in between their neighbours
+            const float u                   = test_randf();
+            const TerrainSample linear      = voxel_terrain_getSampleLinear(heightmap, x + u, (float)y);
+            const TerrainSample neighbour   = voxel_terrain_getSample(heightmap, x + 1, y);
+
+            CHECK(linear.height >= MIN(expected.height, neighbour.height) && linear.height <= MAX(expected.height, neighbour.height),
+                "map %ux%u linear sample %f %i : %u not in [%u, %u]", heightmap->width, heightmap->height, x + u, y, linear.height, expected.height, neighbour.height);
+        }
+
+        voxel_terrain_freeHeightMap(heightmap);
+    }
+}
+
+static void testDraw(void)
+{
+    uint8_t* frame          = (uint8_t*)malloc(FRAME_SIZE + GUARD_SIZE);
+    OcclusionBuffer* buffer = voxel_terrain_newOcclusionBuffer(LCD_COLUMNS, LCD_ROWS);
+
+    DitherMap dithermap;
+    dithermap.sampler       = voxel_terrain_newSampler(32u, 32u);
+    dithermap.data          = (uint8_t*)malloc(32u * 32u);
+
+    for (unsigned int i = 0u; i < 32u * 32u; ++i)
+    {
+        dithermap.data[i] = (uint8_t)test_rand();
+    }
+
+    for (unsigned int m = 0u; m < 64u; ++m)
+    {
+        HeightMap* heightmap = test_newHeightMap(randomSize(), randomSize());
+
+        for (unsigned int c = 0u; c < 4u; ++c)
+        {
+            // Anywhere, including far outside of the map & negative coordinates
+            const Vector3 position  = { test_randf() * 20000.0f - 10000.0f, test_randf() * 1.5f, test_randf() * 20000.0f - 10000.0f };
+            const float yaw         = test_randf() * 7.0f - 3.5f;
+            const float pitch       = test_randf() - 0.5f;
+            const float roll        = test_randf() * 90.0f - 45.0f;
+            const uint16_t far      = (uint16_t)(2u + test_rand() % 1000u);
+
+            memset(frame, 0xFF, FRAME_SIZE);
+            memset(frame + FRAME_SIZE, GUARD_VALUE, GUARD_SIZE);
+
+            voxel_terrain_draw(frame, LCD_ROWSIZE, &dithermap, heightmap, &position, yaw, pitch, roll, 1u, far, 1.0f, 20000.0f, LCD_COLUMNS, LCD_ROWS, buffer);
+
+            int guardIntact = 1;
+
+            for (unsigned int i = 0u; i < GUARD_SIZE; ++i)
+            {
+                guardIntact &= frame[FRAME_SIZE + i] == GUARD_VALUE;
+            }
+
+            CHECK(guardIntact, "map %ux%u view (%f %f %f) wrote past the frame", heightmap->width, heightmap->height, position.x, position.y, position.z);
+        }
+
+        voxel_terrain_freeHeightMap(heightmap);
+    }
+
+    free(dithermap.data);
+    voxel_terrain_freeOcclusionBuffer(buffer);
+    free(frame);
+}
+
+// Maps repeat, so moving the view by a whole map must draw the same frame - including across negative coordinates
+static void testDrawRepeats(void)
+{
+    uint8_t* frame          = (uint8_t*)malloc(FRAME_SIZE);
+    uint8_t* shiftedFrame   = (uint8_t*)malloc(FRAME_SIZE);
+
+    DitherMap dithermap;
+    dithermap.sampler       = voxel_terrain_newSampler(32u, 32u);
+    dithermap.data          = (uint8_t*)malloc(32u * 32u);
+
+    for (unsigned int i = 0u; i < 32u * 32u; ++i)
+    {
+        dithermap.data[i] = (uint8_t)test_rand();
+    }
+
+    HeightMap* heightmap    = test_newHeightMap(64u, 64u);
+
+    for (unsigned int v = 0u; v < 32u; ++v)
+    {
+        // Near the origin so that samples land on both sides of '0', in steps which are exact in floating point
+        const Vector3 position  = { (test_rand() % 256u) / 16.0f - 8.0f, 0.5f + test_randf(), (test_rand() % 256u) / 16.0f - 8.0f };
+        const Vector3 shifted   = { position.x + 64.0f, position.y, position.z + 64.0f };
+        const float yaw         = test_randf() * 7.0f - 3.5f;
+
+        memset(frame, 0xFF, FRAME_SIZE);
+        memset(shiftedFrame, 0xFF, FRAME_SIZE);
+
+        voxel_terrain_draw(frame,        LCD_ROWSIZE, &dithermap, heightmap, &position, yaw, 0.0f, 0.0f, 1u, 64u, 1.0f, 20000.0f, LCD_COLUMNS, LCD_ROWS, NULL);
+        voxel_terrain_draw(shiftedFrame, LCD_ROWSIZE, &dithermap, heightmap, &shifted,  yaw, 0.0f, 0.0f, 1u, 64u, 1.0f, 20000.0f, LCD_COLUMNS, LCD_ROWS, NULL);
+
+        unsigned int differences = 0u;
+
+        for (unsigned int i = 0u; i < FRAME_SIZE; ++i)
+        {
+            differences += frame[i] != shiftedFrame[i];
+        }
+
+        CHECK(differences == 0u, "view (%f %f) yaw %f : %u bytes differ from the shifted view", position.x, position.z, yaw, differences);
+    }
+
+    voxel_terrain_freeHeightMap(heightmap);
+    free(dithermap.data);
+    free(shiftedFrame);
+    free(frame);
+}
+
+int main(void)
+{
+    testWrap();
+    testSamples();
+    testDraw();
+    testDrawRepeats();
+
+    return TEST_RESULT();
+}
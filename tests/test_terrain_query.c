@@ -0,0 +1,169 @@
+#include "test.h"
+#include "terrain_query.h"
+
+// Brute force reference - densely sample the ray against the voxel columns
+static int bruteForceRaycast(const HeightQuery* query, const Vector3* origin, const Vector3* direction, const float maxT, float* tHit)
+{
+    const float lengthXZ    = sqrtf(direction->x * direction->x + direction->z * direction->z);
+    const unsigned int n    = (unsigned int)(maxT * lengthXZ * 512.0f) + 1024u;
+
+    for (unsigned int i = 0u; i <= n; ++i)
+    {
+        const float t = maxT * i / n;
+        const float h = terrain_query_getHeightAt(query, origin->x + direction->x * t, origin->z + direction->z * t);
+
+        if (origin->y + direction->y * t <= h)
+        {
+            *tHit = t;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void checkRay(const HeightQuery* query, const Vector3* origin, const Vector3* direction, const float maxT, int* unresolved)
+{
+    Vector3 hit;
+    float tBrute        = 0.0f;
+    const int result    = terrain_query_raycast(query, origin, direction, maxT, &hit);
+    const int expected  = bruteForceRaycast(query, origin, direction, maxT, &tBrute);
+
+    if (result == QUERY_UNRESOLVED)
+    {
+        // Running out of steps is allowed, it just must not look like a miss
+        (*unresolved)++;
+        return;
+    }
+
+    // A hit the brute force missed is checked below, as it can graze a column in between two samples
+    CHECK(result == QUERY_HIT || !expected, "map %ux%u origin (%f %f %f) direction (%f %f %f) maxT %f : raycast %i brute force %i",
+        query->heightmap->width, query->heightmap->height, origin->x, origin->y, origin->z, direction->x, direction->y, direction->z, maxT, result, expected);
+
+    if (result == QUERY_HIT)
+    {
+        const float tHit = fabsf(direction->x) > fabsf(direction->z) ? (hit.x - origin->x) / direction->x : (hit.z - origin->z) / direction->z;
+
+        // Nothing can be hit before the first sample found below the terrain
+        CHECK(!expected || tHit <= tBrute + 1e-3f, "hit at t=%f, brute force at t=%f", tHit, tBrute);
+
+        // The hit must be real, even when it only grazes a column the brute force stepped over
+        int touches = 0;
+
+        for (int i = -64; i <= 64 && !touches; ++i)
+        {
+            const float t = tHit + i * 1e-4f;
+            const float h = terrain_query_getHeightAt(query, origin->x + direction->x * t, origin->z + direction->z * t);
+
+            touches = origin->y + direction->y * t <= h + 1e-4f;
+        }
+
+        CHECK(touches, "hit at t=%f does not touch the terrain", tHit);
+    }
+}
+
+static void testRandomRays(void)
+{
+    int unresolved = 0;
+
+    for (unsigned int m = 0u; m < 16u; ++m)
+    {
+        HeightMap* heightmap    = test_newHeightMap(1u + test_rand() % 97u, 1u + test_rand() % 97u);
+        HeightQuery* query      = terrain_query_new(heightmap);
+
+        // Short rays from anywhere, including negative coordinates
+        for (unsigned int r = 0u; r < 200u; ++r)
+        {
+            const Vector3 origin    = { test_randf() * 400.0f - 200.0f, 0.5f + test_randf() * 0.6f, test_randf() * 400.0f - 200.0f };
+            const Vector3 direction = { test_randf() * 2.0f - 1.0f, -test_randf() * 0.05f, test_randf() * 2.0f - 1.0f };
+
+            checkRay(query, &origin, &direction, test_randf() * 100.0f, &unresolved);
+        }
+
+        // Long grazing rays just above the highest sample
+        for (unsigned int r = 0u; r < 4u; ++r)
+        {
+            const Vector3 origin    = { test_randf() * 100.0f, 1.0f + test_randf() * 0.01f, test_randf() * 100.0f };
+            const Vector3 direction = { test_randf() * 2.0f - 1.0f, -test_randf() * 1e-5f, test_randf() * 2.0f - 1.0f };
+
+            checkRay(query, &origin, &direction, 1000.0f, &unresolved);
+        }
+
+        terrain_query_free(query);
+        voxel_terrain_freeHeightMap(heightmap);
+    }
+
+    printf("random rays : %i unresolved\n", unresolved);
+}
+
+static void testStepBound(void)
+{
+    // Spikes every 4 samples force the traversal down to the finest levels, with a wall at the far end
+    HeightMap* heightmap = test_newHeightMap(1024u, 64u);
+
+    for (unsigned int i = 0u; i < heightmap->width * heightmap->height; ++i)
+    {
+        heightmap->data[i].height = 0u;
+    }
+
+    for (unsigned int x = 0u; x < heightmap->width; x += 4u)
+    {
+        heightmap->data[x + 3u * heightmap->stride].height = 255u;
+    }
+
+    for (unsigned int z = 0u; z < heightmap->height; ++z)
+    {
+        heightmap->data[1000u + z * heightmap->stride].height = 255u;
+    }
+
+    HeightQuery* query      = terrain_query_new(heightmap);
+    const Vector3 direction = { 1.0f, 0.0f, 0.0f };
+
+    const Vector3 farOrigin     = { 0.5f,   0.5f, 0.5f };
+    const Vector3 nearOrigin    = { 900.5f, 0.5f, 0.5f };
+
+    CHECK(terrain_query_raycast(query, &farOrigin,  &direction, 1100.0f, NULL) != QUERY_MISS, "a long blocked ray must not report a miss");
+    CHECK(terrain_query_raycast(query, &nearOrigin, &direction, 1100.0f, NULL) == QUERY_HIT,  "a short blocked ray must hit");
+
+    // Line of sight treats unresolved rays as blocked
+    const Vector3 from[2]   = { farOrigin, nearOrigin };
+    const Vector3 to[2]     = { { 1010.5f, 0.5f, 0.5f }, { 1010.5f, 0.5f, 0.5f } };
+    uint8_t visible[2]      = { 1u, 1u };
+
+    terrain_query_lineOfSight(query, from, to, visible, 2u);
+
+    CHECK(!visible[0] && !visible[1], "line of sight through the wall : %i %i", visible[0], visible[1]);
+
+    terrain_query_free(query);
+    voxel_terrain_freeHeightMap(heightmap);
+}
+
+static void testHeightAt(void)
+{
+    HeightMap* heightmap    = test_newHeightMap(37u, 53u);
+    HeightQuery* query      = terrain_query_new(heightmap);
+
+    for (unsigned int i = 0u; i < 1000u; ++i)
+    {
+        const float x = test_randf() * 1000.0f - 500.0f;
+        const float z = test_randf() * 1000.0f - 500.0f;
+
+        const float column = terrain_query_getHeightAt(query, x, z);
+        const float linear = terrain_query_getHeightAtLinear(query, x, z);
+
+        CHECK(column == voxel_terrain_getSample(heightmap, (int)floorf(x), (int)floorf(z)).height / 255.0f, "column height at %f %f", x, z);
+        CHECK(linear >= 0.0f && linear <= 1.0f, "linear height at %f %f : %f", x, z, linear);
+    }
+
+    terrain_query_free(query);
+    voxel_terrain_freeHeightMap(heightmap);
+}
+
+int main(void)
+{
+    testRandomRays();
+    testStepBound();
+    testHeightAt();
+
+    return TEST_RESULT();
+}